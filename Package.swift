@@ -24,8 +24,15 @@ let package = Package(
             dependencies: [ "CAtomics" ]),
         .testTarget(
             name: "DeferredTests",
-            dependencies: [ "Deferred" ],
+            dependencies: [ "Deferred", "CAtomics" ],
             exclude: [ "Tests/AllTestsCommon.swift" ]),
+        .testTarget(
+            name: "DeferredBenchmarks",
+            dependencies: [ "Deferred" ]),
+        .target(
+            name: "CPromiseBenchmark",
+            dependencies: [ "CAtomics" ],
+            path: "Tests/CPromiseBenchmark"),
         .target(
             name: "Task",
             dependencies: [ "Deferred", "CAtomics" ]),
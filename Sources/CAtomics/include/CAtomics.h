@@ -56,12 +56,12 @@ const void *_Nullable bnr_atomic_load(bnr_atomic_ptr_t target, bnr_atomic_memory
     return atomic_load_explicit((const void *_Atomic *)target, order);
 }
 
-BNR_ATOMIC_INLINE BNR_ATOMIC_WARN_UNUSED_RESULT
+BNR_ATOMIC_INLINE BNR_ATOMIC_WARN_UNUSED_RESULT BNR_ATOMIC_OVERLOAD
 const void *_Nullable bnr_atomic_exchange(bnr_atomic_ptr_t target, const void *_Nullable desired, bnr_atomic_memory_order_t order) {
     return atomic_exchange_explicit((const void *_Atomic *)target, desired, order);
 }
 
-BNR_ATOMIC_INLINE BNR_ATOMIC_WARN_UNUSED_RESULT
+BNR_ATOMIC_INLINE BNR_ATOMIC_WARN_UNUSED_RESULT BNR_ATOMIC_OVERLOAD
 bool bnr_atomic_compare_and_swap(bnr_atomic_ptr_t target, const void *_Nullable expected, const void *_Nullable desired, bnr_atomic_memory_order_t order, bnr_atomic_memory_order_t failureOrder) {
     return atomic_compare_exchange_strong_explicit((const void *_Atomic *)target, &expected, desired, order, failureOrder);
 }
@@ -78,6 +78,102 @@ void bnr_atomic_store(bnr_atomic_flag_t target, bool desired, bnr_atomic_memory_
     atomic_store_explicit((atomic_bool *)target, desired, order);
 }
 
+typedef volatile int *_Nonnull bnr_atomic_int_t;
+
+BNR_ATOMIC_INLINE BNR_ATOMIC_WARN_UNUSED_RESULT BNR_ATOMIC_OVERLOAD
+int bnr_atomic_load(bnr_atomic_int_t target, bnr_atomic_memory_order_t order) {
+    return atomic_load_explicit((atomic_int *)target, order);
+}
+
+BNR_ATOMIC_INLINE BNR_ATOMIC_OVERLOAD
+void bnr_atomic_store(bnr_atomic_int_t target, int desired, bnr_atomic_memory_order_t order) {
+    atomic_store_explicit((atomic_int *)target, desired, order);
+}
+
+BNR_ATOMIC_INLINE BNR_ATOMIC_WARN_UNUSED_RESULT BNR_ATOMIC_OVERLOAD
+int bnr_atomic_exchange(bnr_atomic_int_t target, int desired, bnr_atomic_memory_order_t order) {
+    return atomic_exchange_explicit((atomic_int *)target, desired, order);
+}
+
+BNR_ATOMIC_INLINE BNR_ATOMIC_WARN_UNUSED_RESULT BNR_ATOMIC_OVERLOAD
+bool bnr_atomic_compare_and_swap(bnr_atomic_int_t target, int expected, int desired, bnr_atomic_memory_order_t order, bnr_atomic_memory_order_t failureOrder) {
+    return atomic_compare_exchange_strong_explicit((atomic_int *)target, &expected, desired, order, failureOrder);
+}
+
+BNR_ATOMIC_INLINE BNR_ATOMIC_OVERLOAD
+int bnr_atomic_fetch_or(bnr_atomic_int_t target, int value, bnr_atomic_memory_order_t order) {
+    return atomic_fetch_or_explicit((atomic_int *)target, value, order);
+}
+
+typedef volatile long *_Nonnull bnr_atomic_counter_t;
+
+BNR_ATOMIC_INLINE BNR_ATOMIC_WARN_UNUSED_RESULT BNR_ATOMIC_OVERLOAD
+long bnr_atomic_load(bnr_atomic_counter_t target, bnr_atomic_memory_order_t order) {
+    return atomic_load_explicit((atomic_long *)target, order);
+}
+
+BNR_ATOMIC_INLINE BNR_ATOMIC_OVERLOAD
+void bnr_atomic_store(bnr_atomic_counter_t target, long desired, bnr_atomic_memory_order_t order) {
+    atomic_store_explicit((atomic_long *)target, desired, order);
+}
+
+BNR_ATOMIC_INLINE BNR_ATOMIC_WARN_UNUSED_RESULT BNR_ATOMIC_OVERLOAD
+bool bnr_atomic_compare_and_swap(bnr_atomic_counter_t target, long expected, long desired, bnr_atomic_memory_order_t order, bnr_atomic_memory_order_t failureOrder) {
+    return atomic_compare_exchange_strong_explicit((atomic_long *)target, &expected, desired, order, failureOrder);
+}
+
+BNR_ATOMIC_INLINE BNR_ATOMIC_OVERLOAD
+long bnr_atomic_fetch_add(bnr_atomic_counter_t target, long value, bnr_atomic_memory_order_t order) {
+    return atomic_fetch_add_explicit((atomic_long *)target, value, order);
+}
+
+BNR_ATOMIC_INLINE BNR_ATOMIC_OVERLOAD
+long bnr_atomic_fetch_or(bnr_atomic_counter_t target, long value, bnr_atomic_memory_order_t order) {
+    return atomic_fetch_or_explicit((atomic_long *)target, value, order);
+}
+
+/// The span of memory kept free of other data around a padded atomic. Apple
+/// silicon uses 128-byte cache lines, and Intel processors prefetch lines in
+/// adjacent pairs, so both get the wider span.
+#if (defined(__aarch64__) && defined(__APPLE__)) || defined(__x86_64__)
+#define BNR_CACHE_LINE_SIZE 128
+#else
+#define BNR_CACHE_LINE_SIZE 64
+#endif
+
+/// A counter that never shares a cache line with the data stored around it,
+/// for words written by many threads at once. Use the counter functions on
+/// a pointer to `value`.
+///
+/// The padding on either side is a full line, rather than relying on the
+/// alignment of the enclosing allocation.
+typedef struct {
+    char leading_padding[BNR_CACHE_LINE_SIZE];
+    volatile long value;
+    char trailing_padding[BNR_CACHE_LINE_SIZE - sizeof(long)];
+} bnr_atomic_padded_counter_t;
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+/// Blocks the calling thread as long as `target` still contains `expected`,
+/// until woken by `bnr_futex_wake` or the relative `timeout` elapses.
+/// A `NULL` timeout blocks indefinitely. Spurious wakeups are possible.
+BNR_ATOMIC_INLINE
+int bnr_futex_wait(bnr_atomic_int_t target, int expected, const struct timespec *_Nullable timeout) {
+    return (int)syscall(SYS_futex, target, FUTEX_WAIT_PRIVATE, expected, timeout, NULL, 0);
+}
+
+/// Wakes up to `count` threads blocked in `bnr_futex_wait` on `target`.
+BNR_ATOMIC_INLINE
+int bnr_futex_wake(bnr_atomic_int_t target, int count) {
+    return (int)syscall(SYS_futex, target, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+#endif
+
 #undef SWIFT_ENUM
 
 #endif // __BNR_DEFERRED_ATOMIC_SHIMS__
@@ -0,0 +1,212 @@
+//
+//  CPromise.h
+//  Deferred
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+//  A promise that native code can fill from any thread. Filling stores the
+//  payload and publishes it with a single atomic operation. Swift takes
+//  ownership of the payload with `bnr_promise_take` when the corresponding
+//  future is read. Only if Swift has registered a handler, because something
+//  is waiting for the future, does the filling thread call into it.
+//
+//  Like the rest of this module, the functions are defined inline, so C code
+//  including this header needs nothing else to link against.
+//
+//  A promise is reference-counted. `bnr_promise_create` returns a promise
+//  with one reference, which the creator passes along or releases. Each
+//  reference is released with `bnr_promise_release`.
+
+#ifndef __BNR_DEFERRED_PROMISE__
+#define __BNR_DEFERRED_PROMISE__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Native libraries may be built by compilers without nullability annotations.
+#if !defined(__clang__)
+#define _Nullable
+#define _Nonnull
+#endif
+
+#define BNR_PROMISE_INLINE static inline __attribute__((always_inline))
+#define BNR_PROMISE_WARN_UNUSED_RESULT __attribute__((warn_unused_result))
+
+/// The value a promise was filled with.
+typedef struct {
+    /// The bytes copied by `bnr_promise_fill_bytes`, or the pointer passed to
+    /// `bnr_promise_fill_pointer`.
+    const void *_Nullable data;
+    /// The number of bytes at `data`, or 0 for a pointer payload.
+    size_t length;
+    /// Whether `data` is a pointer payload rather than a `malloc` buffer owned
+    /// by the promise.
+    bool is_pointer;
+} bnr_promise_payload_t;
+
+struct bnr_promise_s;
+typedef struct bnr_promise_s *bnr_promise_t;
+
+/// Called once on the filling thread when a promise with a handler is
+/// filled, so that the handler can take its payload.
+///
+/// If the last reference to the promise is released before it is filled, the
+/// handler is instead called with a `NULL` promise, so that it can release
+/// its `context`.
+typedef void (*bnr_promise_handler_t)(void *_Nullable context, bnr_promise_t _Nullable promise);
+
+struct bnr_promise_s {
+    volatile long refcount;
+    volatile int state;
+    bnr_promise_payload_t payload;
+    bnr_promise_handler_t _Nullable handler;
+    void *_Nullable context;
+};
+
+/// The bits of `bnr_promise_s.state`.
+enum {
+    /// A filler has won the race and is storing its payload.
+    bnr_promise_state_filling = 1 << 0,
+    /// The payload is stored.
+    bnr_promise_state_filled = 1 << 1,
+    /// The payload has been taken, along with ownership of its bytes.
+    bnr_promise_state_taken = 1 << 2,
+    /// A registrant has won the race and is storing its handler.
+    bnr_promise_state_registering = 1 << 3,
+    /// The handler is stored.
+    bnr_promise_state_registered = 1 << 4
+};
+
+/// Creates an unfilled promise with one reference, or returns `NULL` if it
+/// could not be allocated.
+BNR_PROMISE_INLINE BNR_PROMISE_WARN_UNUSED_RESULT
+bnr_promise_t _Nullable bnr_promise_create(void) {
+    bnr_promise_t promise = (bnr_promise_t)calloc(1, sizeof(struct bnr_promise_s));
+    if (promise) {
+        atomic_init((atomic_long *)&promise->refcount, 1);
+    }
+    return promise;
+}
+
+BNR_PROMISE_INLINE
+void bnr_promise_retain(bnr_promise_t _Nonnull promise) {
+    atomic_fetch_add_explicit((atomic_long *)&promise->refcount, 1, memory_order_relaxed);
+}
+
+BNR_PROMISE_INLINE
+void bnr_promise_release(bnr_promise_t _Nonnull promise) {
+    if (atomic_fetch_sub_explicit((atomic_long *)&promise->refcount, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    int state = atomic_load_explicit((atomic_int *)&promise->state, memory_order_relaxed);
+    if ((state & bnr_promise_state_registered) && !(state & bnr_promise_state_filled)) {
+        promise->handler(promise->context, NULL);
+    }
+    if ((state & bnr_promise_state_filled) && !(state & bnr_promise_state_taken) && !promise->payload.is_pointer) {
+        free((void *)promise->payload.data);
+    }
+    free(promise);
+}
+
+/// Whether the promise has been filled.
+BNR_PROMISE_INLINE BNR_PROMISE_WARN_UNUSED_RESULT
+bool bnr_promise_is_filled(bnr_promise_t _Nonnull promise) {
+    return atomic_load_explicit((atomic_int *)&promise->state, memory_order_acquire) & bnr_promise_state_filled;
+}
+
+/// Publishes a payload that has been stored after winning the fill race.
+BNR_PROMISE_INLINE
+void bnr_promise_publish(bnr_promise_t _Nonnull promise) {
+    int state = atomic_fetch_or_explicit((atomic_int *)&promise->state, bnr_promise_state_filled, memory_order_acq_rel);
+    if (state & bnr_promise_state_registered) {
+        promise->handler(promise->context, promise);
+    }
+}
+
+/// Fills the promise with a copy of `length` bytes at `bytes`.
+///
+/// Returns whether the promise was filled. Fails if it was already filled,
+/// or if the copy could not be allocated.
+BNR_PROMISE_INLINE
+bool bnr_promise_fill_bytes(bnr_promise_t _Nonnull promise, const void *_Nullable bytes, size_t length) {
+    void *copy = NULL;
+    if (length != 0) {
+        copy = malloc(length);
+        if (!copy) {
+            return false;
+        }
+        memcpy(copy, bytes, length);
+    }
+
+    if (atomic_fetch_or_explicit((atomic_int *)&promise->state, bnr_promise_state_filling, memory_order_acquire) & bnr_promise_state_filling) {
+        free(copy);
+        return false;
+    }
+
+    promise->payload.data = copy;
+    promise->payload.length = length;
+    promise->payload.is_pointer = false;
+    bnr_promise_publish(promise);
+    return true;
+}
+
+/// Fills the promise with `pointer`, which the promise does not own.
+///
+/// Returns whether the promise was filled. Fails if it was already filled.
+BNR_PROMISE_INLINE
+bool bnr_promise_fill_pointer(bnr_promise_t _Nonnull promise, void *_Nullable pointer) {
+    if (atomic_fetch_or_explicit((atomic_int *)&promise->state, bnr_promise_state_filling, memory_order_acquire) & bnr_promise_state_filling) {
+        return false;
+    }
+
+    promise->payload.data = pointer;
+    promise->payload.length = 0;
+    promise->payload.is_pointer = true;
+    bnr_promise_publish(promise);
+    return true;
+}
+
+/// Takes the payload of a filled promise, along with ownership of its bytes,
+/// which the caller must release using `free`.
+///
+/// Returns whether `payload` was set. Fails if the promise is not yet filled,
+/// or if its payload was already taken.
+BNR_PROMISE_INLINE BNR_PROMISE_WARN_UNUSED_RESULT
+bool bnr_promise_take(bnr_promise_t _Nonnull promise, bnr_promise_payload_t *_Nonnull payload) {
+    if (!bnr_promise_is_filled(promise)) {
+        return false;
+    }
+    if (atomic_fetch_or_explicit((atomic_int *)&promise->state, bnr_promise_state_taken, memory_order_relaxed) & bnr_promise_state_taken) {
+        return false;
+    }
+
+    *payload = promise->payload;
+    return true;
+}
+
+/// Registers the promise's only handler. If the promise is already filled,
+/// `handler` is called right away on the calling thread.
+///
+/// Returns whether the handler was registered. Fails if another handler was
+/// registered first.
+BNR_PROMISE_INLINE
+bool bnr_promise_set_handler(bnr_promise_t _Nonnull promise, bnr_promise_handler_t _Nonnull handler, void *_Nullable context) {
+    if (atomic_fetch_or_explicit((atomic_int *)&promise->state, bnr_promise_state_registering, memory_order_relaxed) & bnr_promise_state_registering) {
+        return false;
+    }
+
+    promise->handler = handler;
+    promise->context = context;
+    int state = atomic_fetch_or_explicit((atomic_int *)&promise->state, bnr_promise_state_registered, memory_order_acq_rel);
+    if (state & bnr_promise_state_filled) {
+        handler(context, promise);
+    }
+    return true;
+}
+
+#endif // __BNR_DEFERRED_PROMISE__
@@ -89,10 +89,103 @@ func bnr_atomic_store(_ target: bnr_atomic_flag_t, _ desired: Bool, _ order: bnr
     var desired = desired
     DarwinAtomics.shared.store(MemoryLayout<Bool>.size, target, &desired, order)
 }
+
+typealias bnr_atomic_int_t = UnsafeMutablePointer<Int32>
+
+func bnr_atomic_load(_ target: bnr_atomic_int_t, _ order: bnr_atomic_memory_order_t) -> Int32 {
+    var result: Int32 = 0
+    DarwinAtomics.shared.load(MemoryLayout<Int32>.size, target, &result, order)
+    return result
+}
+
+func bnr_atomic_store(_ target: bnr_atomic_int_t, _ desired: Int32, _ order: bnr_atomic_memory_order_t) {
+    var desired = desired
+    DarwinAtomics.shared.store(MemoryLayout<Int32>.size, target, &desired, order)
+}
+
+func bnr_atomic_exchange(_ target: bnr_atomic_int_t, _ desired: Int32, _ order: bnr_atomic_memory_order_t) -> Int32 {
+    var new = desired
+    var old: Int32 = 0
+    DarwinAtomics.shared.exchange(MemoryLayout<Int32>.size, target, &new, &old, order)
+    return old
+}
+
+func bnr_atomic_compare_and_swap(_ target: bnr_atomic_int_t, _ expected: Int32, _ desired: Int32, _ order: bnr_atomic_memory_order_t, _ failureOrder: bnr_atomic_memory_order_t) -> Bool {
+    var expected = expected
+    var desired = desired
+    return DarwinAtomics.shared.compareExchange(MemoryLayout<Int32>.size, target, &expected, &desired, order, failureOrder)
+}
+
+@discardableResult
+func bnr_atomic_fetch_or(_ target: bnr_atomic_int_t, _ value: Int32, _ order: bnr_atomic_memory_order_t) -> Int32 {
+    var expected = bnr_atomic_load(target, .relaxed)
+    var desired = expected | value
+    while !DarwinAtomics.shared.compareExchange(MemoryLayout<Int32>.size, target, &expected, &desired, order, .relaxed) {
+        desired = expected | value
+    }
+    return expected
+}
+
+typealias bnr_atomic_counter_t = UnsafeMutablePointer<Int>
+
+func bnr_atomic_load(_ target: bnr_atomic_counter_t, _ order: bnr_atomic_memory_order_t) -> Int {
+    var result: Int = 0
+    DarwinAtomics.shared.load(MemoryLayout<Int>.size, target, &result, order)
+    return result
+}
+
+func bnr_atomic_store(_ target: bnr_atomic_counter_t, _ desired: Int, _ order: bnr_atomic_memory_order_t) {
+    var desired = desired
+    DarwinAtomics.shared.store(MemoryLayout<Int>.size, target, &desired, order)
+}
+
+func bnr_atomic_compare_and_swap(_ target: bnr_atomic_counter_t, _ expected: Int, _ desired: Int, _ order: bnr_atomic_memory_order_t, _ failureOrder: bnr_atomic_memory_order_t) -> Bool {
+    var expected = expected
+    var desired = desired
+    return DarwinAtomics.shared.compareExchange(MemoryLayout<Int>.size, target, &expected, &desired, order, failureOrder)
+}
+
+@discardableResult
+func bnr_atomic_fetch_add(_ target: bnr_atomic_counter_t, _ value: Int, _ order: bnr_atomic_memory_order_t) -> Int {
+    var expected = bnr_atomic_load(target, .relaxed)
+    var desired = expected &+ value
+    while !DarwinAtomics.shared.compareExchange(MemoryLayout<Int>.size, target, &expected, &desired, order, .relaxed) {
+        desired = expected &+ value
+    }
+    return expected
+}
+
+@discardableResult
+func bnr_atomic_fetch_or(_ target: bnr_atomic_counter_t, _ value: Int, _ order: bnr_atomic_memory_order_t) -> Int {
+    var expected = bnr_atomic_load(target, .relaxed)
+    var desired = expected | value
+    while !DarwinAtomics.shared.compareExchange(MemoryLayout<Int>.size, target, &expected, &desired, order, .relaxed) {
+        desired = expected | value
+    }
+    return expected
+}
+
+let BNR_CACHE_LINE_SIZE: Int32 = 128
+
+struct bnr_atomic_padded_counter_t {
+    private var leading_padding = CacheLinePadding()
+    var value = 0
+    private var trailing_padding = CacheLinePadding()
+}
 #else
 #error("An implementation of threading primitives is not available on this platform. Please open an issue with the Deferred project.")
 #endif
 
+/// Sixteen words, at least `BNR_CACHE_LINE_SIZE` bytes, stored between words
+/// written by different threads so that they never share a cache line.
+///
+/// Use this in place of `bnr_atomic_padded_counter_t` where the padded type
+/// must be visible to inlinable code.
+@usableFromInline
+struct CacheLinePadding {
+    private var words: (Int, Int, Int, Int, Int, Int, Int, Int, Int, Int, Int, Int, Int, Int, Int, Int) = (0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+}
+
 func bnr_atomic_load<T: AnyObject>(_ target: UnsafeMutablePointer<T?>, _ order: bnr_atomic_memory_order_t) -> T? {
     let rawTarget = UnsafeMutableRawPointer(target).assumingMemoryBound(to: UnsafeRawPointer?.self)
     guard let opaqueResult = bnr_atomic_load(rawTarget, order) else { return nil }
@@ -112,6 +205,11 @@ func bnr_atomic_store<T: AnyObject>(_ target: UnsafeMutablePointer<T?>, _ desire
     return Unmanaged<T>.fromOpaque(opaquePrevious).takeRetainedValue()
 }
 
+func bnr_atomic_is_nil<T: AnyObject>(_ target: UnsafeMutablePointer<T?>, _ order: bnr_atomic_memory_order_t) -> Bool {
+    let rawTarget = UnsafeMutableRawPointer(target).assumingMemoryBound(to: UnsafeRawPointer?.self)
+    return bnr_atomic_load(rawTarget, order) == nil
+}
+
 func bnr_atomic_initialize_once<T: AnyObject>(_ target: UnsafeMutablePointer<T?>, _ desired: T) -> Bool {
     let rawTarget = UnsafeMutableRawPointer(target).assumingMemoryBound(to: UnsafeRawPointer?.self)
     let retainedDesired = Unmanaged.passRetained(desired)
@@ -121,25 +219,3 @@ func bnr_atomic_initialize_once<T: AnyObject>(_ target: UnsafeMutablePointer<T?>
     }
     return wonRace
 }
-
-func bnr_atomic_load_and_wait<T: AnyObject>(_ target: UnsafeMutablePointer<T?>) -> T {
-    let rawTarget = UnsafeMutableRawPointer(target).assumingMemoryBound(to: UnsafeRawPointer?.self)
-    var opaqueResult = bnr_atomic_load(rawTarget, .acquire)
-    while opaqueResult == nil {
-        #if canImport(Darwin)
-        pthread_yield_np()
-        #elseif canImport(Glibc)
-        sched_yield()
-        #endif
-        opaqueResult = bnr_atomic_load(rawTarget, .relaxed)
-    }
-    return Unmanaged.fromOpaque(opaqueResult!).takeUnretainedValue()
-}
-
-@discardableResult
-func bnr_atomic_initialize_once(_ target: UnsafeMutablePointer<Bool>, _ handler: () -> Void) -> Bool {
-    guard !bnr_atomic_load(target, .acquire) else { return false }
-    handler()
-    bnr_atomic_store(target, true, .release)
-    return true
-}
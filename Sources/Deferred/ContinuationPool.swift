@@ -0,0 +1,203 @@
+//
+//  ContinuationPool.swift
+//  Deferred
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+#if canImport(Darwin)
+import Darwin
+#elseif canImport(Glibc)
+import Glibc
+#endif
+
+#if SWIFT_PACKAGE || (canImport(CAtomics) && !FORCE_PLAYGROUND_COMPATIBILITY)
+@_implementationOnly import CAtomics
+#endif
+
+/// An opt-in cache of the heap storage `Deferred` uses to enqueue handlers.
+///
+/// Each `upon` to a deferred that is not yet filled, past the first, allocates
+/// a small node that is freed right after the handler is submitted. Under
+/// heavy fan-out, that allocation traffic can dominate. When enabled, drained
+/// nodes are instead kept in a free list for the current thread, spilling a
+/// bounded number over to a list shared by all threads.
+///
+/// The pool is disabled by default. Use `statistics` to check whether it helps
+/// for your workload before relying on it.
+public enum ContinuationPool {
+    /// Counts of how often the pool was able to supply a node.
+    public struct Statistics {
+        /// The number of nodes reused from the pool.
+        public let hits: Int
+        /// The number of nodes that had to be allocated fresh.
+        public let misses: Int
+    }
+
+    /// Whether drained nodes are recycled. Defaults to `false`.
+    ///
+    /// Nodes that are already pooled when recycling is disabled stay cached
+    /// until the thread that holds them exits.
+    public static var isEnabled: Bool {
+        get {
+            return bnr_atomic_load(SharedState.instance.isEnabled, .relaxed)
+        }
+        set {
+            bnr_atomic_store(SharedState.instance.isEnabled, newValue, .relaxed)
+        }
+    }
+
+    /// The pool hits and misses across all threads.
+    ///
+    /// Threads report their counts in batches, so activity on threads other
+    /// than the caller's may lag behind.
+    public static var statistics: Statistics {
+        ThreadCache.current?.reportCounts()
+        let counts = SharedState.instance.counts
+        return Statistics(hits: bnr_atomic_load(counts, .relaxed), misses: bnr_atomic_load(counts + 1, .relaxed))
+    }
+}
+
+extension ContinuationPool {
+    /// The most nodes of a given type a thread will keep for itself.
+    static let threadLimit = 128
+
+    /// The most nodes kept in total on behalf of all threads.
+    static let sharedLimit = 4096
+
+    /// The number of nodes a thread moves to or from the shared list at once.
+    static let batchSize = 32
+
+    /// How many hits and misses a thread counts before reporting them.
+    static let reportingInterval = 256
+
+    private final class SharedState {
+        static let instance = SharedState()
+
+        let isEnabled = UnsafeMutablePointer<Bool>.allocate(capacity: 1)
+        let counts = UnsafeMutablePointer<Int>.allocate(capacity: 2)
+        let lock = NativeLock()
+        var freeNodes = [ObjectIdentifier: [AnyObject]]()
+        var freeNodeCount = 0
+
+        init() {
+            isEnabled.initialize(to: false)
+            counts.initialize(repeating: 0, count: 2)
+        }
+
+        func give(_ nodes: ArraySlice<AnyObject>, for key: ObjectIdentifier) {
+            lock.withWriteLock {
+                let accepted = nodes.prefix(ContinuationPool.sharedLimit - freeNodeCount)
+                freeNodes[key, default: []].append(contentsOf: accepted)
+                freeNodeCount += accepted.count
+            }
+        }
+
+        func take(for key: ObjectIdentifier) -> [AnyObject] {
+            return lock.withWriteLock {
+                guard var available = freeNodes.removeValue(forKey: key) else { return [] }
+                let taken = Array(available.suffix(ContinuationPool.batchSize))
+                available.removeLast(taken.count)
+                freeNodes[key] = available
+                freeNodeCount -= taken.count
+                return taken
+            }
+        }
+    }
+
+    /// The free lists owned by a single thread. Only that thread accesses it,
+    /// so no synchronization is needed beyond the shared list.
+    final class ThreadCache {
+        private var freeNodes = [ObjectIdentifier: [AnyObject]]()
+        private var unreportedHits = 0
+        private var unreportedMisses = 0
+
+        /// The cache for the calling thread, if recycling is enabled.
+        static var current: ThreadCache? {
+            guard ContinuationPool.isEnabled else { return nil }
+            if let opaqueCache = pthread_getspecific(threadCacheKey) {
+                return Unmanaged<ThreadCache>.fromOpaque(opaqueCache).takeUnretainedValue()
+            }
+
+            let cache = ThreadCache()
+            pthread_setspecific(threadCacheKey, Unmanaged.passRetained(cache).toOpaque())
+            return cache
+        }
+
+        deinit {
+            reportCounts()
+            for (key, nodes) in freeNodes {
+                SharedState.instance.give(nodes[...], for: key)
+            }
+        }
+
+        /// Returns a previously-recycled node of the given type, if any.
+        func take<Node: AnyObject>(_: Node.Type) -> Node? {
+            let key = ObjectIdentifier(Node.self)
+            if freeNodes[key]?.isEmpty ?? true {
+                let refill = SharedState.instance.take(for: key)
+                if !refill.isEmpty {
+                    freeNodes[key, default: []].append(contentsOf: refill)
+                }
+            }
+
+            guard let node = freeNodes[key]?.popLast() else {
+                record(hit: false)
+                return nil
+            }
+
+            record(hit: true)
+            return unsafeDowncast(node, to: Node.self)
+        }
+
+        /// Keeps a node that has been prepared for reuse.
+        func recycle<Node: AnyObject>(_ node: Node) {
+            let key = ObjectIdentifier(Node.self)
+            freeNodes[key, default: []].append(node)
+
+            guard let count = freeNodes[key]?.count, count > ContinuationPool.threadLimit,
+                var nodes = freeNodes.removeValue(forKey: key) else { return }
+            SharedState.instance.give(nodes.suffix(ContinuationPool.batchSize), for: key)
+            nodes.removeLast(ContinuationPool.batchSize)
+            freeNodes[key] = nodes
+        }
+
+        private func record(hit: Bool) {
+            if hit {
+                unreportedHits += 1
+            } else {
+                unreportedMisses += 1
+            }
+
+            if unreportedHits + unreportedMisses >= ContinuationPool.reportingInterval {
+                reportCounts()
+            }
+        }
+
+        func reportCounts() {
+            let counts = SharedState.instance.counts
+            bnr_atomic_fetch_add(counts, unreportedHits, .relaxed)
+            bnr_atomic_fetch_add(counts + 1, unreportedMisses, .relaxed)
+            unreportedHits = 0
+            unreportedMisses = 0
+        }
+    }
+}
+
+#if canImport(Darwin)
+private func releaseThreadCache(_ opaqueCache: UnsafeMutableRawPointer) {
+    Unmanaged<ContinuationPool.ThreadCache>.fromOpaque(opaqueCache).release()
+}
+#else
+private func releaseThreadCache(_ opaqueCache: UnsafeMutableRawPointer?) {
+    guard let opaqueCache = opaqueCache else { return }
+    Unmanaged<ContinuationPool.ThreadCache>.fromOpaque(opaqueCache).release()
+}
+#endif
+
+private let threadCacheKey: pthread_key_t = {
+    var key = pthread_key_t()
+    pthread_key_create(&key, releaseThreadCache)
+    return key
+}()
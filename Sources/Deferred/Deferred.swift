@@ -15,6 +15,9 @@ import Dispatch
 ///
 /// Handlers and their captures are strongly referenced until:
 /// - they are executed when the value is determined
+/// - they are cancelled, if registered using `subscribe(upon:execute:)`
+/// - they are skipped because their owner was deallocated, if registered using
+///   `upon(_:weaklyOwnedBy:execute:)`
 /// - the last copy to this type escapes without the value becoming determined
 ///
 /// If the value never becomes determined, a handler submitted to it will never
@@ -22,13 +25,34 @@ import Dispatch
 public struct Deferred<Value> {
     /// The primary storage, initialized with a value once-and-only-once (at
     /// init or later).
-    private let variant: Variant
+    @usableFromInline
+    let variant: Variant
 
+    @inlinable
     public init() {
         variant = Variant()
     }
 
+    /// Creates an instance expecting about `expectedSubscribers` handlers to
+    /// be added before it is filled.
+    ///
+    /// Handlers are stored contiguously in chunks rather than allocated one
+    /// at a time, with the first chunk sized for `expectedSubscribers`. This
+    /// uses less memory and drains faster for deferreds with very many
+    /// handlers. The chunks are freed once the deferred is filled and its
+    /// handlers are submitted.
+    ///
+    /// This layout also suits deferreds that many threads subscribe to and
+    /// read at once. Subscribers reserve slots using a counter padded onto
+    /// its own cache line, so they do not slow down readers checking for a
+    /// value, or one another writing their handlers.
+    public init(expectedSubscribers: Int) {
+        precondition(expectedSubscribers > 0, "Expected subscribers must be positive")
+        variant = Variant(expectedSubscribers: expectedSubscribers)
+    }
+
     /// Creates an instance resolved with `value`.
+    @inlinable
     public init(filledWith value: Value) {
         variant = Variant(for: value)
     }
@@ -36,43 +60,425 @@ public struct Deferred<Value> {
 
 extension Deferred: FutureProtocol {
     /// An enqueued handler.
+    @usableFromInline
     struct Continuation {
+        /// How a handler gets at the determined value.
+        @usableFromInline
+        enum Body {
+            /// Called with a copy of the value.
+            case consuming((Value) -> Void)
+            /// Makes the closure to submit, which reads the value in place.
+            /// The value is never loaded for it, nor captured in the closure.
+            ///
+            /// It is only called while the deferred's storage is alive, so the
+            /// queue need not keep the storage alive, but the closure it makes
+            /// does.
+            case borrowing(() -> () -> Void)
+        }
+
+        @usableFromInline
         let target: Executor?
-        let handler: (Value) -> Void
+        @usableFromInline
+        let body: Body
+        /// Whether `handler` is still worth submitting, if it can be abandoned.
+        /// Abandoned continuations are skipped without being submitted.
+        @usableFromInline
+        let liveness: ContinuationLiveness?
+        /// The order in which the handler is drained relative to others.
+        @usableFromInline
+        let priority: HandlerPriority
+        /// Whether the handler counts against the queue's budget, if any.
+        /// Threads waiting for the value are not handlers, and never do.
+        @usableFromInline
+        let isBudgeted: Bool
+
+        @usableFromInline
+        init(target: Executor?, liveness: ContinuationLiveness? = nil, priority: HandlerPriority = .normal, isBudgeted: Bool = true, body: Body) {
+            self.target = target
+            self.body = body
+            self.liveness = liveness
+            self.priority = priority
+            self.isBudgeted = isBudgeted
+        }
+
+        @usableFromInline
+        init(target: Executor?, liveness: ContinuationLiveness? = nil, priority: HandlerPriority = .normal, isBudgeted: Bool = true, handler: @escaping(Value) -> Void) {
+            self.init(target: target, liveness: liveness, priority: priority, isBudgeted: isBudgeted, body: .consuming(handler))
+        }
     }
 
+    @inlinable
     public func upon(_ executor: Executor, execute body: @escaping(Value) -> Void) {
         let continuation = Continuation(target: executor, handler: body)
         variant.notify(continuation)
     }
 
+    /// Calls some `body` closure once the value is determined, unless the
+    /// returned subscription is cancelled first.
+    ///
+    /// Unlike `upon(_:execute:)`, cancelling releases `body` and its captures
+    /// without waiting for the deferred to be filled. Until then, the deferred
+    /// keeps only a small fixed-size record of the cancelled subscription.
+    ///
+    /// - parameter executor: A context for handling the `body` on fill.
+    /// - parameter body: A closure that uses the determined value.
+    /// - returns: A subscription that can be used to cancel `body`.
+    public func subscribe(upon executor: Executor, execute body: @escaping(Value) -> Void) -> Subscription {
+        let subscription = Subscription(storage: .create(with: body))
+        let continuation = Continuation(target: executor, liveness: subscription.storage, handler: subscription.storage.fire)
+        variant.notify(continuation)
+        return subscription
+    }
+
+    public func upon<Owner: AnyObject>(_ executor: Executor, weaklyOwnedBy owner: Owner, execute body: @escaping(Owner, Value) -> Void) {
+        let weakOwner = WeakOwner(owner: owner, body: body)
+        let continuation = Continuation(target: executor, liveness: weakOwner, handler: weakOwner.fire)
+        variant.notify(continuation)
+    }
+
+    @inlinable
     public func peek() -> Value? {
         return variant.load()
     }
 
+    @inlinable
+    public var isFilled: Bool {
+        return variant.isFilled
+    }
+
     public func wait(until time: DispatchTime) -> Value? {
+        #if os(Linux)
+        if case .native(let storage) = variant {
+            return storage.wait(until: time)
+        }
+        #endif
+
         let semaphore = DispatchSemaphore(value: 0)
         var result: Value?
 
-        let continuation = Continuation(target: nil) { (value) in
+        let continuation = Continuation(target: nil, isBudgeted: false) { (value) in
             result = value
             semaphore.signal()
         }
 
-        variant.notify(continuation)
-
-        guard case .success = semaphore.wait(timeout: time) else { return nil }
+        guard variant.notify(continuation), case .success = semaphore.wait(timeout: time) else { return nil }
         return result
     }
 }
 
+extension Deferred {
+    /// Calls each of the `handlers` once the value is determined, in order, as
+    /// if by calling `upon(_:execute:)` for each.
+    ///
+    /// The handlers are linked together privately, then added to the deferred
+    /// all at once, rather than each contending with other threads adding
+    /// handlers. If the value is already determined, they are submitted right
+    /// away, with consecutive handlers for the same executor submitted
+    /// together.
+    ///
+    /// - parameter handlers: Pairs of a context for handling the body on fill
+    ///   and a closure that uses the determined value.
+    public func upon<Handlers: Sequence>(contentsOf handlers: Handlers) where Handlers.Element == (Executor, (Value) -> Void) {
+        let continuations = handlers.map { (executor, body) in
+            Continuation(target: executor, handler: body)
+        }
+        variant.notify(contentsOf: continuations)
+    }
+
+    /// Executes `continuations` with `value` in one pass.
+    static func execute(_ continuations: [Continuation], with value: Value) {
+        var batch = ContinuationBatch(value: value)
+        defer { batch.flush() }
+
+        for continuation in continuations {
+            batch.append(continuation)
+        }
+    }
+
+    /// Calls `body` with a pointer to the determined value, if any, without
+    /// copying the value out of the deferred.
+    ///
+    /// The pointer is valid only for the duration of `body`.
+    ///
+    /// - returns: The result of `body`, or `nil` if the value is not yet
+    ///   determined.
+    @inlinable
+    public func withFilledValue<Result>(_ body: (UnsafePointer<Value>) throws -> Result) rethrows -> Result? {
+        return try variant.withFilledValue(body)
+    }
+
+    /// Calls some `body` closure with a pointer to the determined value once
+    /// it is determined.
+    ///
+    /// Unlike `upon(_:execute:)`, the value is not copied for `body`. The
+    /// handler keeps the deferred's storage alive instead, and `body` reads
+    /// the value in place once it runs on `executor`. This is cheaper when
+    /// the value is a large struct and many handlers are added. The pointer
+    /// is valid only for the duration of `body`.
+    ///
+    /// Values stored inline in the deferred, or given at init, are read from a
+    /// temporary copy instead.
+    ///
+    /// - parameter executor: A context for handling the `body` on fill.
+    /// - parameter body: A closure that reads the determined value.
+    public func upon(_ executor: Executor, borrowing body: @escaping(UnsafePointer<Value>) -> Void) {
+        // The continuation may wait in the storage's own queue, so it must not
+        // retain the storage until it is executed.
+        let read: () -> () -> Void
+        switch variant {
+        case .object(let storage):
+            read = { [unowned storage] in
+                let variant = Variant.object(storage)
+                return { _ = variant.withFilledValue { body($0) } }
+            }
+        case .native(let storage):
+            read = { [unowned storage] in
+                let variant = Variant.native(storage)
+                return { _ = variant.withFilledValue { body($0) } }
+            }
+        case .inline, .filled:
+            let variant = self.variant
+            read = { { _ = variant.withFilledValue { body($0) } } }
+        }
+        variant.notify(Continuation(target: executor, body: .borrowing(read)))
+    }
+}
+
+/// A condition that a continuation must still meet to be executed, checked
+/// before it is submitted to its executor.
+@usableFromInline
+protocol ContinuationLiveness: AnyObject {
+    var isLive: Bool { get }
+}
+
+extension Deferred {
+    /// A handler that is only called if its owner is still alive.
+    final class WeakOwner<Owner: AnyObject>: ContinuationLiveness {
+        private weak var owner: Owner?
+        private let body: (Owner, Value) -> Void
+
+        init(owner: Owner, body: @escaping(Owner, Value) -> Void) {
+            self.owner = owner
+            self.body = body
+        }
+
+        var isLive: Bool {
+            return owner != nil
+        }
+
+        func fire(with value: Value) {
+            guard let owner = owner else { return }
+            body(owner, value)
+        }
+    }
+}
+
 extension Deferred.Continuation {
+    /// Whether the continuation no longer needs to be executed.
+    var isAbandoned: Bool {
+        guard let liveness = liveness else { return false }
+        return !liveness.isLive
+    }
+
     /// A continuation can be submitted to its passed-in executor or executed
     /// in the current context.
-    func execute(with value: Value) {
-        target?.submit { [handler] in
-            handler(value)
-        } ?? handler(value)
+    ///
+    /// Dispatch queues, by far the most common executor, are submitted to
+    /// directly rather than through the `Executor` witness table, so that the
+    /// submission can be specialized along with the caller.
+    ///
+    /// `value` is only evaluated for a consuming handler, so a borrowing one
+    /// never loads it.
+    @inlinable
+    func execute(with value: @autoclosure() -> Value) {
+        switch body {
+        case .consuming(let handler):
+            let value = value()
+            if let queue = target as? DispatchQueue {
+                queue.async {
+                    handler(value)
+                }
+            } else if let target = target {
+                target.submit {
+                    handler(value)
+                }
+            } else {
+                handler(value)
+            }
+        case .borrowing(let read):
+            if let queue = target as? DispatchQueue {
+                queue.async(execute: read())
+            } else if let target = target {
+                target.submit(read())
+            } else {
+                read()()
+            }
+        }
+    }
+}
+
+extension Deferred {
+    /// Gathers consecutive continuations that target the same executor so they
+    /// can be submitted together using `Executor.submit(contentsOf:)`.
+    ///
+    /// Continuations are submitted in the order they were appended, so each
+    /// executor sees its handlers in FIFO order. Those for executors that do
+    /// not combine batches are executed right away rather than gathered.
+    struct ContinuationBatch {
+        private let value: Value
+        /// The value, boxed once for every handler submitted as part of a
+        /// batch, so each handler's closure retains the box rather than
+        /// copying the value.
+        private var shared: SharedValue?
+        private var target: Executor?
+        private var first: Continuation.Body?
+        private var rest = [Continuation.Body]()
+
+        init(value: Value) {
+            self.value = value
+        }
+
+        mutating func append(_ continuation: Continuation) {
+            if continuation.isAbandoned {
+                return
+            }
+
+            guard let executor = continuation.target, combinesBatches(executor) else {
+                flush()
+                continuation.execute(with: value)
+                return
+            }
+
+            if first != nil && executor === target {
+                rest.append(continuation.body)
+                return
+            }
+
+            flush()
+            target = executor
+            first = continuation.body
+        }
+
+        /// Submits the pending continuations to their executor.
+        mutating func flush() {
+            guard let target = target, let first = first else { return }
+            self.target = nil
+            self.first = nil
+
+            guard !rest.isEmpty else {
+                switch first {
+                case .consuming(let handler):
+                    let value = self.value
+                    target.submit {
+                        handler(value)
+                    }
+                case .borrowing(let read):
+                    target.submit(read())
+                }
+                return
+            }
+
+            var bodies = [() -> Void]()
+            bodies.reserveCapacity(rest.count + 1)
+            bodies.append(submission(for: first))
+            for body in rest {
+                bodies.append(submission(for: body))
+            }
+            rest.removeAll(keepingCapacity: true)
+
+            target.submit(contentsOf: bodies)
+        }
+
+        /// A closure that runs `body` as part of a batch. Consuming handlers
+        /// share one box holding the value; borrowing ones do not need it.
+        private mutating func submission(for body: Continuation.Body) -> () -> Void {
+            switch body {
+            case .consuming(let handler):
+                let shared: SharedValue
+                if let existing = self.shared {
+                    shared = existing
+                } else {
+                    shared = SharedValue(value)
+                    self.shared = shared
+                }
+                return { handler(shared.value) }
+            case .borrowing(let read):
+                return read()
+            }
+        }
+    }
+}
+
+/// Whether `executor` may run a batch of handlers as one, so gathering them
+/// for `Executor.submit(contentsOf:)` is worthwhile.
+///
+/// Dispatch queues other than the main queue may be concurrent, and run each
+/// handler on its own, so their handlers are not gathered.
+private func combinesBatches(_ executor: Executor) -> Bool {
+    guard let queue = executor as? DispatchQueue else { return true }
+    return queue === DispatchQueue.main
+}
+
+extension Deferred {
+    /// A determined value shared by the handlers it is submitted to.
+    final class SharedValue {
+        let value: Value
+
+        init(_ value: Value) {
+            self.value = value
+        }
+    }
+}
+
+extension Deferred {
+    /// Gathers continuations from many deferreds, grouped by executor, so each
+    /// executor is submitted to once.
+    ///
+    /// Each executor sees its handlers in the order they were appended.
+    /// Handlers are only grouped for executors that `combinesBatches`
+    /// accepts: the main queue, and executors other than dispatch queues,
+    /// which decide in `submit(contentsOf:)` whether to run the group as one.
+    /// Any other dispatch queue may be concurrent and gains nothing from a
+    /// group, so its handlers are submitted as they are appended.
+    struct GroupedSubmissions {
+        private var executors = [Executor]()
+        private var bodies = [[() -> Void]]()
+        private var indexes = [ObjectIdentifier: Int]()
+
+        mutating func append(_ continuation: Continuation, with value: Value) {
+            guard !continuation.isAbandoned else { return }
+            guard let executor = continuation.target, combinesBatches(executor) else {
+                continuation.execute(with: value)
+                return
+            }
+
+            let body: () -> Void
+            switch continuation.body {
+            case .consuming(let handler):
+                body = { handler(value) }
+            case .borrowing(let read):
+                body = read()
+            }
+
+            let key = ObjectIdentifier(executor)
+            if let index = indexes[key] {
+                bodies[index].append(body)
+            } else {
+                indexes[key] = executors.count
+                executors.append(executor)
+                bodies.append([ body ])
+            }
+        }
+
+        func submit() {
+            for (executor, bodies) in zip(executors, bodies) {
+                if bodies.count == 1 {
+                    executor.submit(bodies[0])
+                } else {
+                    executor.submit(contentsOf: bodies)
+                }
+            }
+        }
     }
 }
 
@@ -82,8 +488,41 @@ extension Deferred {
     /// Filling a deferred value should usually be attempted only once.
     ///
     /// - returns: Whether the promise was fulfilled with `value`.
+    @inlinable
     @discardableResult
     public func fill(with value: Value) -> Bool {
         return variant.store(value)
     }
+
+    /// Determines each deferred with its paired value, then submits all of
+    /// their handlers at once.
+    ///
+    /// Every value is published before any handler runs. Handlers across all
+    /// of the deferreds are then grouped by executor, and each executor
+    /// receives its handlers in one call to `Executor.submit(contentsOf:)`.
+    /// This is cheaper than calling `fill(with:)` on each deferred in turn
+    /// when many share the same executors.
+    ///
+    /// - returns: The number of deferreds that were filled by this call.
+    @discardableResult
+    public static func fill<Pairs: Sequence>(_ pairs: Pairs) -> Int where Pairs.Element == (Deferred<Value>, Value) {
+        var published = [(Deferred<Value>, Value)]()
+        for (deferred, value) in pairs {
+            guard deferred.variant.publish(value) else { continue }
+            published.append((deferred, value))
+        }
+
+        var submissions = GroupedSubmissions()
+        for (deferred, value) in published {
+            deferred.variant.withQueue { (pointerToQueue) in
+                var detached = detach(from: pointerToQueue)
+                detached.forEachInDrainOrder { (continuation) in
+                    submissions.append(continuation, with: value)
+                }
+            }
+        }
+        submissions.submit()
+
+        return published.count
+    }
 }
@@ -0,0 +1,156 @@
+//
+//  DeferredArena.swift
+//  Deferred
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+#if canImport(Darwin)
+import Darwin
+#elseif canImport(Glibc)
+import Glibc
+#endif
+
+#if SWIFT_PACKAGE || (canImport(CAtomics) && !FORCE_PLAYGROUND_COMPATIBILITY)
+@_implementationOnly import CAtomics
+#endif
+
+/// A scope for the short-lived deferreds, futures, and handler storage
+/// created while handling one unit of work, like a server request.
+///
+/// Swift allocates each of these as a separate reference-counted object, so
+/// they cannot be carved out of one contiguous block. Instead, while an arena
+/// is installed on a thread, the nodes `Deferred` uses to enqueue handlers
+/// are drawn from the arena, and drained nodes are returned to it, so a
+/// graph of deferreds reuses the same few nodes. Everything the arena keeps
+/// is released together when the arena is deallocated.
+///
+/// Nothing is reclaimed while it is still referenced. A deferred or future
+/// that escapes the scope stays on the heap as usual, and outlives the arena.
+///
+/// `map` and `andThen` run their transforms with the arena that was
+/// installed when they were called, so the work they start is counted
+/// toward the same scope.
+public final class DeferredArena {
+    /// Counts of what was allocated while an arena was installed.
+    public struct Statistics {
+        /// The heap bytes allocated for deferreds and their handler storage.
+        public let bytesAllocated: Int
+        /// The number of objects allocated.
+        public let allocationCount: Int
+        /// The number of handler nodes reused from the arena instead of being
+        /// allocated.
+        public let reuseCount: Int
+    }
+
+    private let limit: Int
+    private let lock = NativeLock()
+    private var freeNodes = [ObjectIdentifier: [AnyObject]]()
+    private var freeNodeCount = 0
+    /// Bytes allocated, objects allocated, and nodes reused.
+    private let counts = UnsafeMutablePointer<Int>.allocate(capacity: 3)
+
+    /// Creates an arena that keeps at most `limit` drained nodes for reuse.
+    public init(limit: Int = 256) {
+        precondition(limit >= 0, "Arena must have a non-negative limit")
+        self.limit = limit
+        counts.initialize(repeating: 0, count: 3)
+    }
+
+    deinit {
+        counts.deinitialize(count: 3)
+        counts.deallocate()
+    }
+
+    /// Calls `body` with the arena installed on the calling thread, restoring
+    /// whichever arena was installed before once it returns.
+    public func withInstalled<Result>(_ body: () throws -> Result) rethrows -> Result {
+        let previous = pthread_getspecific(arenaKey)
+        pthread_setspecific(arenaKey, Unmanaged.passUnretained(self).toOpaque())
+        bnr_atomic_fetch_add(DeferredArena.installedCount, 1, .relaxed)
+        defer {
+            bnr_atomic_fetch_add(DeferredArena.installedCount, -1, .relaxed)
+            pthread_setspecific(arenaKey, previous)
+        }
+
+        return try body()
+    }
+
+    /// What has been allocated while the arena was installed so far.
+    public var statistics: Statistics {
+        return Statistics(bytesAllocated: bnr_atomic_load(counts, .relaxed), allocationCount: bnr_atomic_load(counts + 1, .relaxed), reuseCount: bnr_atomic_load(counts + 2, .relaxed))
+    }
+}
+
+extension DeferredArena {
+    /// The number of threads with an arena installed, so that looking for the
+    /// current arena costs a single load while none are in use.
+    private static let installedCount: UnsafeMutablePointer<Int> = {
+        let count = UnsafeMutablePointer<Int>.allocate(capacity: 1)
+        count.initialize(to: 0)
+        return count
+    }()
+
+    /// The arena installed on the calling thread, if any.
+    static var current: DeferredArena? {
+        guard bnr_atomic_load(installedCount, .relaxed) != 0, let opaqueArena = pthread_getspecific(arenaKey) else { return nil }
+        return Unmanaged<DeferredArena>.fromOpaque(opaqueArena).takeUnretainedValue()
+    }
+
+    /// Counts a freshly-allocated `object` toward the arena's statistics.
+    func recordAllocation(of object: AnyObject) {
+        bnr_atomic_fetch_add(counts, allocatedSize(of: object), .relaxed)
+        bnr_atomic_fetch_add(counts + 1, 1, .relaxed)
+    }
+
+    /// Returns a previously-recycled node of the given type, if any.
+    func take<Node: AnyObject>(_: Node.Type) -> Node? {
+        let key = ObjectIdentifier(Node.self)
+        let node = lock.withWriteLock { () -> AnyObject? in
+            guard let node = freeNodes[key]?.popLast() else { return nil }
+            freeNodeCount -= 1
+            return node
+        }
+
+        guard let reused = node else { return nil }
+        bnr_atomic_fetch_add(counts + 2, 1, .relaxed)
+        return unsafeDowncast(reused, to: Node.self)
+    }
+
+    /// Keeps a node that has been prepared for reuse.
+    ///
+    /// - returns: Whether the arena had room for the node.
+    func recycle<Node: AnyObject>(_ node: Node) -> Bool {
+        return lock.withWriteLock {
+            guard freeNodeCount < limit else { return false }
+            freeNodes[ObjectIdentifier(Node.self), default: []].append(node)
+            freeNodeCount += 1
+            return true
+        }
+    }
+}
+
+extension Optional where Wrapped == DeferredArena {
+    /// Calls `body` with the arena installed, if there is one.
+    func withInstalled<Result>(_ body: () throws -> Result) rethrows -> Result {
+        guard let arena = self else { return try body() }
+        return try arena.withInstalled(body)
+    }
+}
+
+/// The number of bytes the allocator reserved for `object`.
+private func allocatedSize(of object: AnyObject) -> Int {
+    let pointer = Unmanaged.passUnretained(object).toOpaque()
+    #if canImport(Darwin)
+    return malloc_size(pointer)
+    #else
+    return malloc_usable_size(pointer)
+    #endif
+}
+
+private let arenaKey: pthread_key_t = {
+    var key = pthread_key_t()
+    pthread_key_create(&key, nil)
+    return key
+}()
@@ -0,0 +1,174 @@
+//
+//  DeferredBudget.swift
+//  Deferred
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+#if SWIFT_PACKAGE || (canImport(CAtomics) && !FORCE_PLAYGROUND_COMPATIBILITY)
+@_implementationOnly import CAtomics
+#endif
+
+extension Deferred {
+    /// A limit on the number of handlers that may wait for a deferred to be
+    /// filled, and what to do with handlers added past the limit.
+    ///
+    /// Without a budget, a deferred that is never filled, or is filled late,
+    /// keeps every handler added to it. A budget bounds that memory.
+    public struct Budget {
+        /// What happens to a handler added while the budget is exhausted.
+        public enum Overflow {
+            /// The handler is released without being called.
+            case reject
+            /// The handler is submitted right away with a sentinel value instead
+            /// of waiting for the deferred to be filled.
+            case substitute(Value)
+            /// The handler is submitted to a fallback executor with a sentinel
+            /// value instead of waiting for the deferred to be filled.
+            case divert(to: Executor, substituting: Value)
+        }
+
+        /// The most handlers that may wait at once.
+        public let limit: Int
+
+        /// What happens to handlers added past `limit`.
+        public let overflow: Overflow
+
+        public init(limit: Int, overflow: Overflow = .reject) {
+            precondition(limit > 0, "Budget must have a positive limit")
+            self.limit = limit
+            self.overflow = overflow
+        }
+    }
+
+    /// Creates an instance that keeps at most `budget.limit` handlers waiting
+    /// for it to be filled.
+    ///
+    /// Handlers added once the budget is exhausted are handled by its overflow
+    /// policy instead. Handlers waiting on the deferred count against the
+    /// budget until it is filled, including those whose subscription was
+    /// cancelled or whose owner was deallocated. Threads blocked in
+    /// `wait(until:)` do not count, and always wait for the value.
+    public init(budget: Budget) {
+        var queue = Queue()
+        queue.budget = BudgetState(budget)
+        variant = Variant(queue: queue)
+    }
+
+    /// Calls some `body` closure once the value is determined, unless the
+    /// deferred's budget is exhausted.
+    ///
+    /// - parameter executor: A context for handling the `body` on fill.
+    /// - parameter body: A closure that uses the determined value.
+    /// - returns: `false` if the budget was exhausted, and `body` was handled
+    ///   by its overflow policy instead. Always `true` for a deferred without
+    ///   a budget.
+    @discardableResult
+    public func tryUpon(_ executor: Executor, execute body: @escaping(Value) -> Void) -> Bool {
+        return variant.notify(Continuation(target: executor, handler: body))
+    }
+
+    /// The most handlers that have been waiting at once, or `nil` if the
+    /// deferred was not created with a budget.
+    public var pendingHighWaterMark: Int? {
+        var highWaterMark: Int?
+        variant.withQueue { (pointerToQueue) in
+            highWaterMark = pointerToQueue.pointee.budget?.highWaterMark
+        }
+        return highWaterMark
+    }
+
+    /// Reserves room in the queue's budget for `continuation`, if it has one
+    /// and the continuation counts against it.
+    ///
+    /// - returns: Whether the continuation may be pushed. If not, its overflow
+    ///   policy has been applied.
+    static func admit(_ continuation: Continuation, to target: UnsafeMutablePointer<Queue>) -> Bool {
+        guard continuation.isBudgeted, let budget = target.pointee.budget, !budget.reserve(1) else { return true }
+        budget.overflow(continuation)
+        return false
+    }
+
+    /// Reserves room in the queue's budget for as many of `continuations` as
+    /// fit, in order, applying the overflow policy to the rest.
+    ///
+    /// - returns: The continuations that may be pushed.
+    static func admit(contentsOf continuations: [Continuation], to target: UnsafeMutablePointer<Queue>) -> [Continuation] {
+        guard let budget = target.pointee.budget else { return continuations }
+        let admittedCount = budget.reserve(upTo: continuations.count)
+        for continuation in continuations[admittedCount...] {
+            budget.overflow(continuation)
+        }
+        return Array(continuations[..<admittedCount])
+    }
+
+    /// The shared count of continuations waiting in a queue with a budget.
+    final class BudgetState {
+        private let limit: Int
+        private let policy: Budget.Overflow
+        /// The number of continuations waiting, then the most there have been.
+        private let counts = UnsafeMutablePointer<Int>.allocate(capacity: 2)
+
+        init(_ budget: Budget) {
+            limit = budget.limit
+            policy = budget.overflow
+            counts.initialize(repeating: 0, count: 2)
+        }
+
+        deinit {
+            counts.deinitialize(count: 2)
+            counts.deallocate()
+        }
+
+        var highWaterMark: Int {
+            return bnr_atomic_load(counts + 1, .relaxed)
+        }
+
+        /// Counts `count` more continuations as waiting, if they all fit.
+        func reserve(_ count: Int) -> Bool {
+            return reserve(upTo: count) == count
+        }
+
+        /// Counts as many as `count` more continuations as waiting as fit.
+        ///
+        /// - returns: The number reserved.
+        func reserve(upTo count: Int) -> Int {
+            var pending = bnr_atomic_load(counts, .relaxed)
+            while true {
+                let reserved = min(count, limit - pending)
+                guard reserved > 0 else { return 0 }
+                if bnr_atomic_compare_and_swap(counts, pending, pending + reserved, .relaxed, .relaxed) {
+                    raiseHighWaterMark(to: pending + reserved)
+                    return reserved
+                }
+                pending = bnr_atomic_load(counts, .relaxed)
+            }
+        }
+
+        private func raiseHighWaterMark(to pending: Int) {
+            var highWaterMark = bnr_atomic_load(counts + 1, .relaxed)
+            while highWaterMark < pending, !bnr_atomic_compare_and_swap(counts + 1, highWaterMark, pending, .relaxed, .relaxed) {
+                highWaterMark = bnr_atomic_load(counts + 1, .relaxed)
+            }
+        }
+
+        /// Returns room for `count` continuations that are no longer waiting.
+        func release(_ count: Int) {
+            guard count != 0 else { return }
+            bnr_atomic_fetch_add(counts, -count, .relaxed)
+        }
+
+        /// Handles a continuation that did not fit.
+        func overflow(_ continuation: Continuation) {
+            switch policy {
+            case .reject:
+                break
+            case .substitute(let sentinel):
+                continuation.execute(with: sentinel)
+            case let .divert(executor, sentinel):
+                Continuation(target: executor, body: continuation.body).execute(with: sentinel)
+            }
+        }
+    }
+}
@@ -6,6 +6,8 @@
 //  Copyright © 2018 Big Nerd Ranch. Licensed under MIT.
 //
 
+import Dispatch
+
 extension Deferred {
     /// Heap storage acting as a linked list node of continuations.
     ///
@@ -14,12 +16,21 @@ extension Deferred {
     /// next node.
     final class Node: ManagedBuffer<Node?, Continuation> {
         static func create(with continuation: Continuation) -> Node {
+            let arena = DeferredArena.current
+            if let node = arena?.take(Node.self) ?? ContinuationPool.ThreadCache.current?.take(Node.self) {
+                node.withUnsafeMutablePointers { (_, pointerToContinuation) in
+                    pointerToContinuation.pointee = continuation
+                }
+                return node
+            }
+
             let storage = super.create(minimumCapacity: 1, makingHeaderWith: { _ in nil })
 
             storage.withUnsafeMutablePointers { (_, pointerToContinuation) in
                 pointerToContinuation.initialize(to: continuation)
             }
 
+            arena?.recordAllocation(of: storage)
             return unsafeDowncast(storage, to: Node.self)
         }
 
@@ -32,59 +43,589 @@ extension Deferred {
 
     /// A singly-linked list of continuations to be submitted after fill.
     ///
-    /// A multi-producer, single-consumer atomic queue a la `DispatchGroup`:
-    /// <https://github.com/apple/swift-corelibs-libdispatch/blob/master/src/semaphore.c>.
+    /// Producers push onto a lock-free stack (a Treiber stack) with a single
+    /// compare-and-swap, and the consumer detaches the whole stack at once and
+    /// reverses it to restore submission order. Unlike a linked queue with
+    /// separate head and tail, the consumer never has to wait for a producer
+    /// that was preempted between publishing a node and linking it.
+    ///
+    /// Most deferreds only ever have one subscriber, so the first continuation
+    /// is stored inline, and nodes are only allocated for later ones.
+    ///
+    /// A queue created for an expected number of subscribers instead appends
+    /// later continuations into chunks. See `Deferred.Chunk`.
+    @usableFromInline
     struct Queue {
-        fileprivate(set) var head: Node?
-        fileprivate(set) var tail: Node?
+        fileprivate(set) var top: Node?
+        fileprivate var firstState = InlineState.empty.rawValue
+        fileprivate var first: Continuation?
+        /// The most recently added chunk, if continuations are stored in
+        /// chunks.
+        fileprivate var chunks: Chunk?
+        /// Chunks that have been drained while a producer may still have been
+        /// appending to one it found earlier, so they are kept until the queue
+        /// is destroyed. Drained chunks are otherwise freed with the drain.
+        fileprivate var retiredChunks: Chunk?
+        /// The number of producers appending to a chunk they have not
+        /// retained.
+        fileprivate var appenderCount = 0
+        /// The number of continuations in each chunk after the first, or `0`
+        /// if continuations are stored in nodes.
+        fileprivate let chunkCapacity: Int
+        /// The limit on continuations waiting in the queue, if any.
+        var budget: BudgetState?
+        /// Whether any continuation with other than normal priority has been
+        /// pushed, so draining must sort them. Set before the continuation is
+        /// published, and loaded once every detached chunk has been sealed.
+        fileprivate var hasPriorities = false
+
+        init() {
+            chunkCapacity = 0
+        }
+
+        /// Creates a queue that stores continuations in chunks, with the first
+        /// sized for `expectedSubscribers`.
+        init(expectedSubscribers: Int) {
+            chunkCapacity = Chunk.defaultCapacity
+            chunks = Chunk.create(capacity: expectedSubscribers)
+        }
     }
+
+    /// Heap storage for a run of continuations, used by queues created with an
+    /// expected number of subscribers.
+    ///
+    /// A producer reserves a slot by incrementing the cursor, so appending to a
+    /// chunk with room left costs a single atomic add rather than allocating a
+    /// node. The continuations are stored contiguously, so draining walks
+    /// memory in order. Chunks are linked newest-first, like nodes.
+    final class Chunk: ManagedBuffer<ChunkHeader, ChunkSlot> {
+        /// The number of continuations in chunks allocated after the first.
+        static var defaultCapacity: Int {
+            return 32
+        }
+
+        static func create(capacity: Int) -> Chunk {
+            let storage = super.create(minimumCapacity: capacity, makingHeaderWith: { _ in ChunkHeader(capacity: capacity) })
+
+            storage.withUnsafeMutablePointers { (_, pointerToSlots) in
+                pointerToSlots.initialize(repeating: ChunkSlot(), count: capacity)
+            }
+
+            DeferredArena.current?.recordAllocation(of: storage)
+            return unsafeDowncast(storage, to: Chunk.self)
+        }
+
+        /// Creates a chunk whose first slot is already filled by
+        /// `continuation`.
+        static func create(capacity: Int, with continuation: Continuation) -> Chunk {
+            let chunk = create(capacity: capacity)
+            chunk.withUnsafeMutablePointers { (pointerToHeader, pointerToSlots) in
+                pointerToHeader.pointee.cursor.value = 1
+                pointerToSlots.pointee = ChunkSlot(state: SlotState.ready.rawValue, continuation: continuation)
+            }
+            return chunk
+        }
+
+        /// Creates a chunk exactly large enough for `continuations`, which
+        /// are already stored.
+        static func create(containing continuations: ArraySlice<Continuation>) -> Chunk {
+            let chunk = create(capacity: continuations.count)
+            chunk.withUnsafeMutablePointers { (pointerToHeader, pointerToSlots) in
+                pointerToHeader.pointee.cursor.value = continuations.count
+                for (index, continuation) in zip(0..., continuations) {
+                    pointerToSlots[index] = ChunkSlot(state: SlotState.ready.rawValue, continuation: continuation)
+                }
+            }
+            return chunk
+        }
+
+        deinit {
+            withUnsafeMutablePointers { (pointerToHeader, pointerToSlots) in
+                pointerToSlots.deinitialize(count: pointerToHeader.pointee.capacity)
+
+                // Release older chunks one at a time, rather than recursively.
+                var next = pointerToHeader.pointee.next
+                pointerToHeader.pointee.next = nil
+                while var current = next {
+                    next = nil
+                    guard isKnownUniquelyReferenced(&current) else { break }
+                    next = current.header.next
+                    current.header.next = nil
+                }
+            }
+        }
+    }
+
+    /// The tail-allocated header used for `Chunk`.
+    struct ChunkHeader {
+        /// The number of slots reserved so far. The sign bit is set once the
+        /// chunk has been drained.
+        ///
+        /// Every producer increments the cursor, so it is padded onto a cache
+        /// line of its own, away from the slots being written.
+        var cursor = bnr_atomic_padded_counter_t()
+        let capacity: Int
+        /// The chunk that was the most recent before this one.
+        var next: Chunk?
+
+        init(capacity: Int) {
+            self.capacity = capacity
+        }
+    }
+
+    /// A continuation stored in a `Chunk`.
+    struct ChunkSlot {
+        var state = SlotState.empty.rawValue
+        var continuation: Continuation?
+    }
+}
+
+/// The progress of the continuation stored inline in a `Deferred.Queue`.
+private enum InlineState: Int32 {
+    /// No continuation has been stored yet.
+    case empty
+    /// A producer has reserved the slot and is storing its continuation.
+    case claimed
+    /// A continuation is stored and waiting to be drained.
+    case ready
+    /// The slot has been drained; later continuations go to the linked list.
+    case drained
+}
+
+/// The progress of a continuation stored in a `Deferred.Chunk`.
+private enum SlotState: Int32 {
+    /// The slot has not been written to, or is being written to.
+    case empty
+    /// A continuation is stored and waiting to be drained.
+    case ready
+    /// The slot has been drained. A producer still writing to it must append
+    /// its continuation elsewhere.
+    case drained
+}
+
+/// Links the object at `opaqueSelf` on top of the stack starting at `top`,
+/// given a pointer to its own link.
+///
+/// The previous top is copied into the link bitwise, so the stack's reference
+/// to it becomes the new object's without retaining or releasing it, and
+/// losing a race with another producer only costs a reload.
+///
+/// - returns: Whether the stack was empty.
+private func link(_ opaqueSelf: UnsafeRawPointer, through rawNext: UnsafeMutablePointer<UnsafeRawPointer?>, onto rawTop: UnsafeMutablePointer<UnsafeRawPointer?>) -> Bool {
+    while true {
+        let opaqueNext = bnr_atomic_load(rawTop, .relaxed)
+        rawNext.pointee = opaqueNext
+        if bnr_atomic_compare_and_swap(rawTop, opaqueNext, opaqueSelf, .acq_rel, .relaxed) {
+            return opaqueNext == nil
+        }
+    }
+}
+
+/// Reinterprets a pointer to a stored reference as a pointer to its bits.
+private func rawReference<T: AnyObject>(_ target: UnsafeMutablePointer<T?>) -> UnsafeMutablePointer<UnsafeRawPointer?> {
+    return UnsafeMutableRawPointer(target).assumingMemoryBound(to: UnsafeRawPointer?.self)
 }
 
 private extension Deferred.Node {
-    /// The next node in the linked list.
+    /// Links `self`, and any nodes below it in `bottom`, on top of the stack
+    /// starting at `top`.
     ///
-    /// - warning: To alleviate data races, the next node is loaded
-    ///   unconditionally. `self` must have been checked not to be the tail.
-    var next: Deferred.Node {
-        get {
-            return withUnsafeMutablePointers { (target, _) in
-                bnr_atomic_load_and_wait(target)
-            }
+    /// - returns: Whether the stack was empty.
+    func push(onto top: UnsafeMutablePointer<Deferred.Node?>, below bottom: Deferred.Node? = nil) -> Bool {
+        let opaqueSelf = UnsafeRawPointer(Unmanaged.passRetained(self).toOpaque())
+        return (bottom ?? self).withUnsafeMutablePointers { (target, _) -> Bool in
+            link(opaqueSelf, through: rawReference(target), onto: rawReference(top))
         }
-        set {
-            _ = withUnsafeMutablePointers { (target, _) in
-                bnr_atomic_store(target, newValue, .relaxed)
+    }
+
+    var continuation: Deferred.Continuation {
+        return withUnsafeMutablePointers { (_, pointerToContinuation) in
+            pointerToContinuation.pointee
+        }
+    }
+
+    /// Releases the link and the handler's captures, leaving the node with an
+    /// empty continuation so it is always safe to deinitialize.
+    func prepareForReuse() {
+        withUnsafeMutablePointers { (target, pointerToContinuation) in
+            _ = bnr_atomic_store(target, nil, .relaxed)
+            pointerToContinuation.pointee = Deferred.Continuation(target: nil, handler: { _ in })
+        }
+    }
+}
+
+/// The outcome of appending to a `Deferred.Chunk`.
+private enum AppendResult {
+    /// The continuation was stored.
+    case appended
+    /// The chunk has no room left.
+    case full
+    /// The chunk was drained first; the queue must be reloaded.
+    case drained
+}
+
+private extension Deferred.Chunk {
+    /// Stores `continuation` in the next free slot, if there is one.
+    func append(_ continuation: Deferred.Continuation) -> AppendResult {
+        return withUnsafeMutablePointers { (pointerToHeader, pointerToSlots) -> AppendResult in
+            // Releases the queue's priority mark to the drain that seals the
+            // chunk.
+            let index = bnr_atomic_fetch_add(&pointerToHeader.pointee.cursor.value, 1, .release)
+            if index < 0 {
+                return .drained
+            } else if index >= pointerToHeader.pointee.capacity {
+                return .full
             }
+
+            let slot = pointerToSlots + index
+            slot.pointee.continuation = continuation
+            if bnr_atomic_compare_and_swap(&slot.pointee.state, SlotState.empty.rawValue, SlotState.ready.rawValue, .release, .relaxed) {
+                return .appended
+            }
+
+            // The drain passed over the slot while it was being written to.
+            slot.pointee.continuation = nil
+            return .drained
+        }
+    }
+
+    /// Links `self`, and any chunks below it in `bottom`, on top of the stack
+    /// starting at `top`.
+    ///
+    /// - returns: Whether the stack was empty.
+    func push(onto top: UnsafeMutablePointer<Deferred.Chunk?>, below bottom: Deferred.Chunk? = nil) -> Bool {
+        let opaqueSelf = UnsafeRawPointer(Unmanaged.passRetained(self).toOpaque())
+        return (bottom ?? self).withUnsafeMutablePointers { (pointerToHeader, _) -> Bool in
+            link(opaqueSelf, through: rawReference(&pointerToHeader.pointee.next), onto: rawReference(top))
         }
     }
 
-    func execute(with value: Value) {
-        withUnsafeMutablePointers { (_, pointerToContinuation) in
-            pointerToContinuation.pointee.execute(with: value)
+    /// Prevents any more slots from being reserved.
+    ///
+    /// - returns: The number of slots that were reserved.
+    func seal() -> Int {
+        return withUnsafeMutablePointers { (pointerToHeader, _) -> Int in
+            min(bnr_atomic_fetch_or(&pointerToHeader.pointee.cursor.value, Int.min, .acquire), pointerToHeader.pointee.capacity)
+        }
+    }
+
+    /// Removes the continuation at `index` if its producer finished storing it
+    /// before the drain got to it.
+    func take(at index: Int) -> Deferred.Continuation? {
+        return withUnsafeMutablePointers { (_, pointerToSlots) -> Deferred.Continuation? in
+            let slot = pointerToSlots + index
+            guard bnr_atomic_exchange(&slot.pointee.state, SlotState.drained.rawValue, .acquire) == SlotState.ready.rawValue else { return nil }
+            defer { slot.pointee.continuation = nil }
+            return slot.pointee.continuation
         }
     }
 }
 
 extension Deferred {
-    static func drain(from target: UnsafeMutablePointer<Queue>, continuingWith value: Value) {
-        var head = bnr_atomic_store(&target.pointee.head, nil, .relaxed)
-        let tail = head != nil ? bnr_atomic_store(&target.pointee.tail, nil, .release) : nil
+    /// Executes every continuation in the queue with `value`.
+    ///
+    /// Consecutive continuations that target the same executor are submitted
+    /// to it as one batch. If `DrainOffload` is enabled and enough
+    /// continuations are waiting, they are instead submitted from background
+    /// threads in chunks, and this returns right away. Continuations pushed
+    /// after that are not queued behind the offloaded ones.
+    ///
+    /// `owner` is the storage holding `target`. Borrowing handlers read the
+    /// value from it without the queue keeping it alive, so offloaded
+    /// continuations keep it alive until they have been submitted.
+    @usableFromInline
+    static func drain(from target: UnsafeMutablePointer<Queue>, continuingWith value: Value, owner: AnyObject? = nil) {
+        let detached = detach(from: target)
 
-        while let current = head {
-            head = current !== tail ? current.next : nil
-            current.execute(with: value)
+        if let threshold = DrainOffload.activeThreshold, detached.hasContinuations(atLeast: threshold) {
+            let chunkSize = DrainOffload.chunkSize
+            DispatchQueue.any().async {
+                withExtendedLifetime(owner) {
+                    var detached = detached
+                    detached.submitInChunks(of: chunkSize, continuingWith: value)
+                }
+            }
+            return
+        }
+
+        var remaining = detached
+        var batch = ContinuationBatch(value: value)
+        defer { batch.flush() }
+
+        remaining.forEachInDrainOrder { (continuation) in
+            batch.append(continuation)
         }
     }
 
-    static func push(_ continuation: Continuation, to target: UnsafeMutablePointer<Queue>) -> Bool {
-        let node = Node.create(with: continuation)
+    /// Removes every continuation from the queue without visiting them.
+    static func detach(from target: UnsafeMutablePointer<Queue>) -> DetachedContinuations {
+        var detached = DetachedContinuations()
+        if bnr_atomic_exchange(&target.pointee.firstState, InlineState.drained.rawValue, .acq_rel) == InlineState.ready.rawValue {
+            detached.first = target.pointee.first
+            target.pointee.first = nil
+        }
+
+        detached.top = bnr_atomic_store(&target.pointee.top, nil, .acq_rel)
+        detached.budget = target.pointee.budget
+
+        if target.pointee.chunkCapacity != 0, let newest = bnr_atomic_store(&target.pointee.chunks, nil, .seq_cst) {
+            var current: Chunk? = newest
+            while let chunk = current {
+                detached.chunks.append((chunk, chunk.seal()))
+                current = chunk.header.next
+            }
+            detached.chunks.reverse()
+
+            // Producers count themselves before loading the newest chunk, so
+            // if none are counted now, none can reach the detached chunks, and
+            // they are freed once drained. Otherwise, the oldest chunk, which
+            // links to nothing, is linked to the earlier retired chunks.
+            if bnr_atomic_load(&target.pointee.appenderCount, .seq_cst) != 0 {
+                _ = newest.push(onto: &target.pointee.retiredChunks, below: detached.chunks[0].chunk)
+            }
+        }
+
+        // Every continuation that will be taken was published by storing it
+        // inline, by linking it, or by reserving its slot before its chunk was
+        // sealed, each of which this has since acquired. So this sees any mark
+        // stored before a continuation was published.
+        detached.hasPriorities = bnr_atomic_load(&target.pointee.hasPriorities, .acquire)
+
+        return detached
+    }
+
+    /// Continuations that have been removed from a queue. Once detached, no
+    /// producer can reach the nodes, so they are relinked without atomics.
+    struct DetachedContinuations {
+        fileprivate var first: Continuation?
+        /// The most recently pushed node.
+        fileprivate var top: Node?
+        /// The detached chunks, oldest first, each with the number of slots
+        /// reserved before it was sealed.
+        fileprivate var chunks = [(chunk: Chunk, count: Int)]()
+        /// The budget to return the detached continuations to.
+        fileprivate var budget: BudgetState?
+        /// Whether the continuations must be sorted by priority.
+        fileprivate var hasPriorities = false
+
+        /// Whether at least `count` continuations were detached, walking no
+        /// more than that many nodes.
+        func hasContinuations(atLeast count: Int) -> Bool {
+            var seen = chunks.reduce(0) { $0 + $1.count }
+            var current = top
+            while let node = current, seen < count {
+                seen += 1
+                current = node.header
+            }
+            return seen >= count
+        }
+
+        /// Passes each continuation to `body` in the order they were pushed,
+        /// leaving `self` empty.
+        mutating func forEach(_ body: (Continuation) -> Void) {
+            var count = 0
+            defer { budget?.release(count) }
+
+            if let first = first {
+                self.first = nil
+                count += first.isBudgeted ? 1 : 0
+                body(first)
+            }
+
+            let chunks = self.chunks
+            self.chunks.removeAll()
+            for (chunk, reserved) in chunks {
+                for index in 0 ..< reserved {
+                    if let continuation = chunk.take(at: index) {
+                        count += continuation.isBudgeted ? 1 : 0
+                        body(continuation)
+                    }
+                }
+            }
+
+            // The stack is newest-first; reverse it.
+            var top = self.top
+            self.top = nil
+            var head: Node?
+            while let current = top {
+                top = current.header
+                current.header = head
+                head = current
+            }
+
+            let arena = DeferredArena.current
+            let cache = ContinuationPool.ThreadCache.current
+
+            while var current = head {
+                head = current.header
+                current.header = nil
+                let continuation = current.continuation
+                count += continuation.isBudgeted ? 1 : 0
+                body(continuation)
+
+                // A producer may still briefly hold the node it just pushed.
+                guard arena != nil || cache != nil, isKnownUniquelyReferenced(&current) else { continue }
+                current.prepareForReuse()
+                if arena?.recycle(current) != true {
+                    cache?.recycle(current)
+                }
+            }
+        }
+
+        /// Passes each continuation to `body`, those with a higher priority
+        /// first and otherwise in the order they were pushed, leaving `self`
+        /// empty.
+        ///
+        /// Unless some continuation has a priority, this is `forEach(_:)`,
+        /// and costs nothing more.
+        mutating func forEachInDrainOrder(_ body: (Continuation) -> Void) {
+            guard hasPriorities else { return forEach(body) }
+
+            var continuations = [Continuation]()
+            forEach { (continuation) in
+                continuations.append(continuation)
+            }
+
+            let order = continuations.indices.sorted { (lhs, rhs) -> Bool in
+                let lhsPriority = continuations[lhs].priority
+                let rhsPriority = continuations[rhs].priority
+                return lhsPriority != rhsPriority ? lhsPriority > rhsPriority : lhs < rhs
+            }
+            for index in order {
+                body(continuations[index])
+            }
+        }
+
+        /// Splits the continuations into runs of `chunkSize` and submits the
+        /// runs concurrently, blocking until all have been submitted.
+        mutating func submitInChunks(of chunkSize: Int, continuingWith value: Value) {
+            var continuations = [Continuation]()
+            forEachInDrainOrder { (continuation) in
+                continuations.append(continuation)
+            }
+
+            let chunkCount = (continuations.count + chunkSize - 1) / chunkSize
+            DispatchQueue.concurrentPerform(iterations: chunkCount) { (chunk) in
+                var batch = ContinuationBatch(value: value)
+                defer { batch.flush() }
 
-        if let tail = bnr_atomic_store(&target.pointee.tail, node, .release) {
-            tail.next = node
+                let start = chunk * chunkSize
+                for continuation in continuations[start ..< min(start + chunkSize, continuations.count)] {
+                    batch.append(continuation)
+                }
+            }
+        }
+    }
+
+    /// Whether there are no continuations waiting to be drained, either
+    /// because none were ever pushed or `drain(from:continuingWith:)` has
+    /// already detached them.
+    ///
+    /// The top and newest chunk are checked without retaining them, as the
+    /// filling thread may be releasing them concurrently.
+    @usableFromInline
+    static func isEmpty(_ target: UnsafeMutablePointer<Queue>) -> Bool {
+        switch bnr_atomic_load(&target.pointee.firstState, .acquire) {
+        case InlineState.claimed.rawValue, InlineState.ready.rawValue:
             return false
+        default:
+            return bnr_atomic_is_nil(&target.pointee.top, .acquire) && bnr_atomic_is_nil(&target.pointee.chunks, .acquire)
+        }
+    }
+
+    /// Adds `continuation` to the queue.
+    ///
+    /// - returns: Whether the caller must check for a value and drain the
+    ///   queue, as it may have been filled in the meantime.
+    @usableFromInline
+    static func push(_ continuation: Continuation, to target: UnsafeMutablePointer<Queue>) -> Bool {
+        markPriority(of: continuation, in: target)
+
+        // Check before claiming the inline slot, so that once it is taken,
+        // producers only read the queue's line rather than writing to it.
+        if bnr_atomic_load(&target.pointee.firstState, .relaxed) == InlineState.empty.rawValue,
+            bnr_atomic_compare_and_swap(&target.pointee.firstState, InlineState.empty.rawValue, InlineState.claimed.rawValue, .relaxed, .relaxed) {
+            target.pointee.first = continuation
+
+            if bnr_atomic_compare_and_swap(&target.pointee.firstState, InlineState.claimed.rawValue, InlineState.ready.rawValue, .release, .relaxed) {
+                return false
+            }
+
+            // The queue was drained while the slot was being written to. Mark
+            // it ready again so the caller's drain picks it back up.
+            bnr_atomic_store(&target.pointee.firstState, InlineState.ready.rawValue, .release)
+            return true
+        }
+
+        guard target.pointee.chunkCapacity != 0 else {
+            return Node.create(with: continuation).push(onto: &target.pointee.top)
+        }
+
+        // The chunk is not retained while appending to it. It may be drained
+        // concurrently, but while this producer is counted, it is retired
+        // rather than freed.
+        bnr_atomic_fetch_add(&target.pointee.appenderCount, 1, .seq_cst)
+        defer { bnr_atomic_fetch_add(&target.pointee.appenderCount, -1, .release) }
+
+        let rawChunks = rawReference(&target.pointee.chunks)
+        while let opaqueChunk = bnr_atomic_load(rawChunks, .seq_cst) {
+            switch Unmanaged<Chunk>.fromOpaque(opaqueChunk).takeUnretainedValue().append(continuation) {
+            case .appended:
+                return false
+            case .full:
+                return Chunk.create(capacity: target.pointee.chunkCapacity, with: continuation).push(onto: &target.pointee.chunks)
+            case .drained:
+                continue
+            }
+        }
+
+        return Chunk.create(capacity: target.pointee.chunkCapacity, with: continuation).push(onto: &target.pointee.chunks)
+    }
+
+    /// Marks the queue as needing to be sorted when drained if `continuation`
+    /// has other than normal priority. Call this before publishing it.
+    private static func markPriority(of continuation: Continuation, in target: UnsafeMutablePointer<Queue>) {
+        guard continuation.priority != .normal, !bnr_atomic_load(&target.pointee.hasPriorities, .relaxed) else { return }
+        bnr_atomic_store(&target.pointee.hasPriorities, true, .release)
+    }
+
+    /// Adds `continuations` to the queue in order.
+    ///
+    /// The first is pushed as usual, so it may take the inline slot. The rest
+    /// are linked together privately, then onto the queue with a single
+    /// compare-and-swap.
+    ///
+    /// - returns: Whether the caller must check for a value and drain the
+    ///   queue, as it may have been filled in the meantime.
+    static func push(contentsOf continuations: [Continuation], to target: UnsafeMutablePointer<Queue>) -> Bool {
+        guard let first = continuations.first else { return false }
+        let pushedFirst = push(first, to: target)
+        let rest = continuations.dropFirst()
+        guard !rest.isEmpty else { return pushedFirst }
+
+        for continuation in rest {
+            markPriority(of: continuation, in: target)
+        }
+
+        if target.pointee.chunkCapacity != 0 {
+            let pushedRest = Chunk.create(containing: rest).push(onto: &target.pointee.chunks)
+            return pushedFirst || pushedRest
+        }
+
+        // Link newest-first, as if each had been pushed in turn.
+        var top: Node?
+        var bottom: Node?
+        for continuation in rest {
+            let node = Node.create(with: continuation)
+            node.header = top
+            top = node
+            if bottom == nil {
+                bottom = node
+            }
         }
 
-        _ = bnr_atomic_store(&target.pointee.head, node, .seq_cst)
-        return true
+        // swiftlint:disable:next force_unwrapping
+        let pushedRest = top!.push(onto: &target.pointee.top, below: bottom)
+        return pushedFirst || pushedRest
     }
 }
@@ -0,0 +1,265 @@
+//
+//  DeferredSlab.swift
+//  Deferred
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+import Dispatch
+
+#if SWIFT_PACKAGE || (canImport(CAtomics) && !FORCE_PLAYGROUND_COMPATIBILITY)
+@_implementationOnly import CAtomics
+#endif
+
+/// A fixed number of deferred values sharing a single heap allocation.
+///
+/// Creating many `Deferred` values at once allocates each separately. A slab
+/// instead tail-allocates the fill state, handler queue, and value for every
+/// slot in one buffer, and hands out lightweight `Slot` handles that each
+/// behave like a `Deferred`.
+///
+/// Because the fill states are packed together as bits, the slab can answer
+/// questions about all of its slots, like `filledCount`, a machine word at a
+/// time.
+///
+/// Each slot's value and handlers are kept alive as long as any handle to the
+/// slab is.
+public struct DeferredSlab<Value> {
+    private let storage: Storage
+
+    /// Creates a slab of `count` unfilled slots.
+    public init(count: Int) {
+        precondition(count >= 0, "Slab must have a non-negative count")
+        storage = .create(count: count)
+    }
+
+    /// The number of slots that have been filled.
+    public var filledCount: Int {
+        return storage.filledCount()
+    }
+
+    /// Returns the index of the first slot at or after `index` that has not
+    /// been filled, or `nil` if they all have.
+    public func firstUnfilledIndex(from index: Int = 0) -> Int? {
+        return storage.firstUnfilledIndex(from: index)
+    }
+}
+
+extension DeferredSlab: RandomAccessCollection {
+    public var startIndex: Int {
+        return 0
+    }
+
+    public var endIndex: Int {
+        return storage.header.count
+    }
+
+    public subscript(position: Int) -> Slot {
+        precondition(indices.contains(position), "Slab index out of range")
+        return Slot(storage: storage, index: position)
+    }
+}
+
+extension DeferredSlab {
+    /// A handle to one deferred value in a slab.
+    public struct Slot {
+        fileprivate let storage: Storage
+
+        /// The position of this slot in its slab.
+        public let index: Int
+
+        /// Determines the slot with `value`.
+        ///
+        /// Filling a slot should usually be attempted only once.
+        ///
+        /// - returns: Whether the slot was filled with `value`.
+        @discardableResult
+        public func fill(with value: Value) -> Bool {
+            return storage.store(value, at: index)
+        }
+    }
+}
+
+extension DeferredSlab.Slot: FutureProtocol {
+    public func upon(_ executor: Executor, execute body: @escaping(Value) -> Void) {
+        let continuation = Deferred<Value>.Continuation(target: executor, handler: body)
+        storage.notify(continuation, at: index)
+    }
+
+    public func peek() -> Value? {
+        return storage.load(at: index)
+    }
+
+    public func wait(until time: DispatchTime) -> Value? {
+        let semaphore = DispatchSemaphore(value: 0)
+        var result: Value?
+
+        let continuation = Deferred<Value>.Continuation(target: nil) { (value) in
+            result = value
+            semaphore.signal()
+        }
+
+        storage.notify(continuation, at: index)
+
+        guard case .success = semaphore.wait(timeout: time) else { return nil }
+        return result
+    }
+}
+
+extension DeferredSlab {
+    /// The counts and byte offsets describing the tail-allocated regions.
+    struct Header {
+        let count: Int
+        let wordCount: Int
+        let queuesOffset: Int
+        var valuesOffset: Int
+    }
+
+    /// Heap storage for every slot in a slab.
+    ///
+    /// The tail allocation holds, in order: a bitmap of claimed slots, which
+    /// at most one filler may set per slot; a bitmap of filled slots, which
+    /// publishes each value; a `Deferred.Queue` per slot; and space for a
+    /// value per slot.
+    final class Storage: ManagedBuffer<Header, Int> {
+        fileprivate static func create(count: Int) -> Storage {
+            let wordCount = (count + Int.bitWidth - 1) / Int.bitWidth
+            let queuesOffset = align(2 * wordCount * MemoryLayout<Int>.stride, to: MemoryLayout<Deferred<Value>.Queue>.alignment)
+            let unalignedValuesOffset = queuesOffset + count * MemoryLayout<Deferred<Value>.Queue>.stride
+            // Leave room to align the values, if they need more than a word.
+            let byteCount = unalignedValuesOffset + count * MemoryLayout<Value>.stride + MemoryLayout<Value>.alignment
+            let capacity = (byteCount + MemoryLayout<Int>.stride - 1) / MemoryLayout<Int>.stride
+
+            let storage = super.create(minimumCapacity: capacity, makingHeaderWith: { _ in
+                Header(count: count, wordCount: wordCount, queuesOffset: queuesOffset, valuesOffset: unalignedValuesOffset)
+            })
+
+            storage.withUnsafeMutablePointers { (pointerToHeader, pointerToWords) in
+                let base = Int(bitPattern: pointerToWords)
+                pointerToHeader.pointee.valuesOffset = align(base + unalignedValuesOffset, to: MemoryLayout<Value>.alignment) - base
+
+                pointerToWords.initialize(repeating: 0, count: 2 * wordCount)
+                let raw = UnsafeMutableRawPointer(pointerToWords)
+                raw.advanced(by: queuesOffset)
+                    .bindMemory(to: Deferred<Value>.Queue.self, capacity: count)
+                    .initialize(repeating: Deferred<Value>.Queue(), count: count)
+                _ = raw.advanced(by: pointerToHeader.pointee.valuesOffset)
+                    .bindMemory(to: Value.self, capacity: count)
+            }
+
+            return unsafeDowncast(storage, to: Storage.self)
+        }
+
+        deinit {
+            withUnsafeMutablePointers { (pointerToHeader, pointerToWords) in
+                let header = pointerToHeader.pointee
+                let regions = Regions<Value>(header: header, words: pointerToWords)
+                for index in 0 ..< header.count where regions.isFilled(at: index, .relaxed) {
+                    (regions.values + index).deinitialize(count: 1)
+                }
+                regions.queues.deinitialize(count: header.count)
+                pointerToWords.deinitialize(count: 2 * header.wordCount)
+            }
+        }
+
+        private func withRegions<Return>(_ body: (Regions<Value>) throws -> Return) rethrows -> Return {
+            return try withUnsafeMutablePointers { (pointerToHeader, pointerToWords) in
+                try body(Regions<Value>(header: pointerToHeader.pointee, words: pointerToWords))
+            }
+        }
+
+        /// Adds the `continuation` to the slot's queue, draining it if the slot
+        /// has been filled. Mirrors `Deferred.Variant.notify(_:)`.
+        func notify(_ continuation: Deferred<Value>.Continuation, at index: Int) {
+            withRegions { (regions) in
+                let queue = regions.queues + index
+                if regions.isFilled(at: index, .acquire), Deferred<Value>.isEmpty(queue) {
+                    continuation.execute(with: regions.values[index])
+                    return
+                }
+
+                guard Deferred<Value>.push(continuation, to: queue),
+                    regions.isFilled(at: index, .seq_cst) else { return }
+                Deferred<Value>.drain(from: queue, continuingWith: regions.values[index])
+            }
+        }
+
+        func load(at index: Int) -> Value? {
+            return withRegions { (regions) in
+                regions.isFilled(at: index, .acquire) ? regions.values[index] : nil
+            }
+        }
+
+        func store(_ value: Value, at index: Int) -> Bool {
+            return withRegions { (regions) in
+                let (word, mask) = bitPosition(of: index)
+                guard bnr_atomic_fetch_or(regions.claimed + word, mask, .acquire) & mask == 0 else { return false }
+                (regions.values + index).initialize(to: value)
+                bnr_atomic_fetch_or(regions.filled + word, mask, .seq_cst)
+                Deferred<Value>.drain(from: regions.queues + index, continuingWith: value)
+                return true
+            }
+        }
+
+        func filledCount() -> Int {
+            return withRegions { (regions) in
+                (0 ..< regions.wordCount).reduce(0) { (sum, word) in
+                    sum + bnr_atomic_load(regions.filled + word, .relaxed).nonzeroBitCount
+                }
+            }
+        }
+
+        func firstUnfilledIndex(from start: Int) -> Int? {
+            return withRegions { (regions) in
+                guard start < regions.count else { return nil }
+                let (firstWord, _) = bitPosition(of: max(start, 0))
+                for word in firstWord ..< regions.wordCount {
+                    var unfilled = ~bnr_atomic_load(regions.filled + word, .relaxed)
+                    if word == firstWord {
+                        unfilled &= ~0 << (max(start, 0) % Int.bitWidth)
+                    }
+
+                    guard unfilled != 0 else { continue }
+                    let index = word * Int.bitWidth + unfilled.trailingZeroBitCount
+                    return index < regions.count ? index : nil
+                }
+                return nil
+            }
+        }
+    }
+}
+
+/// Typed pointers to the regions of a `DeferredSlab.Storage`.
+private struct Regions<Value> {
+    let count: Int
+    let wordCount: Int
+    let claimed: UnsafeMutablePointer<Int>
+    let filled: UnsafeMutablePointer<Int>
+    let queues: UnsafeMutablePointer<Deferred<Value>.Queue>
+    let values: UnsafeMutablePointer<Value>
+
+    init(header: DeferredSlab<Value>.Header, words: UnsafeMutablePointer<Int>) {
+        count = header.count
+        wordCount = header.wordCount
+        claimed = words
+        filled = words + header.wordCount
+        let raw = UnsafeMutableRawPointer(words)
+        queues = raw.advanced(by: header.queuesOffset).assumingMemoryBound(to: Deferred<Value>.Queue.self)
+        values = raw.advanced(by: header.valuesOffset).assumingMemoryBound(to: Value.self)
+    }
+
+    func isFilled(at index: Int, _ order: bnr_atomic_memory_order_t) -> Bool {
+        let (word, mask) = bitPosition(of: index)
+        return bnr_atomic_load(filled + word, order) & mask != 0
+    }
+}
+
+/// The word and bit mask for the slot at `index` in either bitmap.
+private func bitPosition(of index: Int) -> (word: Int, mask: Int) {
+    return (index / Int.bitWidth, 1 << (index % Int.bitWidth))
+}
+
+private func align(_ offset: Int, to alignment: Int) -> Int {
+    return (offset + alignment - 1) & ~(alignment - 1)
+}
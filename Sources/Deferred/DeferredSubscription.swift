@@ -0,0 +1,99 @@
+//
+//  DeferredSubscription.swift
+//  Deferred
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+#if SWIFT_PACKAGE || (canImport(CAtomics) && !FORCE_PLAYGROUND_COMPATIBILITY)
+@_implementationOnly import CAtomics
+#endif
+
+extension Deferred {
+    /// A handle to a handler registered using `subscribe(upon:execute:)`.
+    ///
+    /// Cancelling the subscription releases the handler and its captures
+    /// immediately, even if the deferred is never filled. Copies of a
+    /// subscription all refer to the same handler.
+    public struct Subscription {
+        let storage: SubscriptionStorage
+
+        /// Prevents the handler from being called and releases it.
+        ///
+        /// - returns: Whether the handler was cancelled before it began
+        ///   executing.
+        @discardableResult
+        public func cancel() -> Bool {
+            return storage.cancel()
+        }
+
+        /// Whether `cancel()` has been called before the handler began
+        /// executing.
+        public var isCancelled: Bool {
+            return storage.isCancelled
+        }
+    }
+}
+
+extension Deferred {
+    /// Heap storage for a cancellable handler.
+    ///
+    /// Firing and cancelling both race to move the state out of `pending`;
+    /// the winner takes ownership of the handler, so it is called or released
+    /// exactly once.
+    final class SubscriptionStorage: ManagedBuffer<Int32, ((Value) -> Void)?>, ContinuationLiveness {
+        static func create(with handler: @escaping(Value) -> Void) -> SubscriptionStorage {
+            let storage = super.create(minimumCapacity: 1, makingHeaderWith: { _ in SubscriptionState.pending.rawValue })
+
+            storage.withUnsafeMutablePointers { (_, pointerToHandler) in
+                pointerToHandler.initialize(to: handler)
+            }
+
+            return unsafeDowncast(storage, to: SubscriptionStorage.self)
+        }
+
+        deinit {
+            _ = withUnsafeMutablePointers { (_, pointerToHandler) in
+                pointerToHandler.deinitialize(count: 1)
+            }
+        }
+
+        /// Takes the handler if neither firing nor cancelling has already.
+        private func take(movingTo state: SubscriptionState) -> ((Value) -> Void)? {
+            return withUnsafeMutablePointers { (pointerToState, pointerToHandler) in
+                guard bnr_atomic_compare_and_swap(pointerToState, SubscriptionState.pending.rawValue, state.rawValue, .acquire, .relaxed) else { return nil }
+                defer { pointerToHandler.pointee = nil }
+                return pointerToHandler.pointee
+            }
+        }
+
+        func fire(with value: Value) {
+            take(movingTo: .fired)?(value)
+        }
+
+        func cancel() -> Bool {
+            return take(movingTo: .cancelled) != nil
+        }
+
+        var isCancelled: Bool {
+            return withUnsafeMutablePointers { (pointerToState, _) in
+                bnr_atomic_load(pointerToState, .relaxed) == SubscriptionState.cancelled.rawValue
+            }
+        }
+
+        var isLive: Bool {
+            return !isCancelled
+        }
+    }
+}
+
+/// The progress of a `Deferred.SubscriptionStorage`.
+private enum SubscriptionState: Int32 {
+    /// Neither called nor cancelled.
+    case pending
+    /// Cancelled before the handler began executing.
+    case cancelled
+    /// The handler has been claimed to be called.
+    case fired
+}
@@ -6,6 +6,11 @@
 //  Copyright © 2018 Big Nerd Ranch. Licensed under MIT.
 //
 
+import Dispatch
+#if canImport(Glibc)
+import Glibc
+#endif
+
 #if SWIFT_PACKAGE || (canImport(CAtomics) && !FORCE_PLAYGROUND_COMPATIBILITY)
 @_implementationOnly import CAtomics
 #endif
@@ -23,22 +28,32 @@ extension Deferred {
     ///   it? **A:** We want raw memory because Swift reserves the right to
     ///   lay out properties opaquely. To that end, the initial store done
     ///   during `init` counts as unsafe access to TSAN.
+    @usableFromInline
     enum Variant {
         case object(ObjectVariant)
         case native(NativeVariant)
+        /// A value whose bits fit in `InlineValue.Bits`, filled at init.
+        case inline(InlineValue.Bits)
         indirect case filled(Value)
     }
 
     /// Heap storage that is initialized once and only once from `nil` to a
     /// reference. See `Deferred.Variant` for more details.
+    @usableFromInline
     final class ObjectVariant: ManagedBuffer<Queue, AnyObject?> {
-        fileprivate static func create() -> ObjectVariant {
-            let storage = super.create(minimumCapacity: 1, makingHeaderWith: { _ in Queue() })
+        @usableFromInline
+        static func create() -> ObjectVariant {
+            return create(with: Queue())
+        }
+
+        static func create(with queue: Queue) -> ObjectVariant {
+            let storage = super.create(minimumCapacity: 1, makingHeaderWith: { _ in queue })
 
             storage.withUnsafeMutablePointers { (_, pointerToValue) in
                 pointerToValue.initialize(to: nil)
             }
 
+            DeferredArena.current?.recordAllocation(of: storage)
             return unsafeDowncast(storage, to: ObjectVariant.self)
         }
 
@@ -49,17 +64,25 @@ extension Deferred {
         }
     }
 
-    /// Heap storage that is initialized once and only once using a flag.
+    /// Heap storage that is initialized once and only once using a state word.
     /// See `Deferred.Variant` for more details.
+    @usableFromInline
     final class NativeVariant: ManagedBuffer<NativeHeader, Value> {
-        fileprivate static func create() -> NativeVariant {
-            let storage = super.create(minimumCapacity: 1, makingHeaderWith: { _ in NativeHeader() })
+        @usableFromInline
+        static func create() -> NativeVariant {
+            return create(with: Queue())
+        }
+
+        static func create(with queue: Queue) -> NativeVariant {
+            assert(MemoryLayout<NativeHeader>.offset(of: \NativeHeader.state).unsafelyUnwrapped - MemoryLayout<Queue>.size >= Int(BNR_CACHE_LINE_SIZE), "The state must not share a cache line with the queue")
+            let storage = super.create(minimumCapacity: 1, makingHeaderWith: { _ in NativeHeader(queue: queue) })
+            DeferredArena.current?.recordAllocation(of: storage)
             return unsafeDowncast(storage, to: NativeVariant.self)
         }
 
         deinit {
             withUnsafeMutablePointers { (pointerToHeader, pointerToValue) in
-                if pointerToHeader.pointee.isInitialized {
+                if FillState(rawValue: pointerToHeader.pointee.state).contains(.filled) {
                     pointerToValue.deinitialize(count: 1)
                 }
             }
@@ -67,13 +90,46 @@ extension Deferred {
     }
 
     /// The tail-allocated header used for `NativeStorage`.
+    ///
+    /// Readers poll the state and then load the value, while subscribers
+    /// write to the queue. The state is padded a full cache line past the
+    /// queue, so that it shares a line with the value rather than with the
+    /// words subscribers write to.
+    @usableFromInline
     struct NativeHeader {
-        fileprivate var isInitialized = false
-        fileprivate var queue = Queue()
+        @usableFromInline
+        var queue = Queue()
+        fileprivate var padding = CacheLinePadding()
+        @usableFromInline
+        var state = FillState().rawValue
+    }
+}
+
+/// The progress of filling a `Deferred.NativeVariant`, and whether any
+/// threads are parked waiting for it.
+///
+/// Only the filler that sets `filling` first may write the value, so
+/// concurrent fills never both write the value or both drain the queue.
+private struct FillState: OptionSet {
+    let rawValue: Int32
+
+    /// A filler has won the race and is storing its value.
+    static let filling = FillState(rawValue: 1 << 0)
+    /// The value is stored and may be read.
+    static let filled = FillState(rawValue: 1 << 1)
+    /// One thread parked on the state word until it is filled. The bits from
+    /// this one up count the parked threads, so the count returns to zero as
+    /// waiters leave, including those that time out.
+    static let waiter = FillState(rawValue: 1 << 2)
+
+    /// Whether any threads are parked on the state word.
+    var hasWaiters: Bool {
+        return rawValue >= FillState.waiter.rawValue
     }
 }
 
 extension Deferred.Variant {
+    @inlinable
     init() {
         if Value.self is AnyObject.Type {
             self = .object(.create())
@@ -82,64 +138,362 @@ extension Deferred.Variant {
         }
     }
 
+    @inlinable
     init(for value: Value) {
-        self = .filled(value)
+        if let bits = InlineValue.pack(value) {
+            self = .inline(bits)
+        } else {
+            self = .filled(value)
+        }
+    }
+
+    init(expectedSubscribers: Int) {
+        self.init(queue: Deferred.Queue(expectedSubscribers: expectedSubscribers))
+    }
+
+    init(queue: Deferred.Queue) {
+        if Value.self is AnyObject.Type {
+            self = .object(.create(with: queue))
+        } else {
+            self = .native(.create(with: queue))
+        }
     }
 }
 
 extension Deferred.Variant {
     /// Adds the `continuation` to the queue. If filled, drain the queue to
     /// execute it immediately.
-    func notify(_ continuation: Deferred.Continuation) {
+    ///
+    /// If the value is already published and nothing is left in the queue
+    /// ahead of it, the continuation is executed directly without being
+    /// enqueued. The value is only loaded if the continuation consumes it. Continuations pushed before the fill still go first, as they
+    /// keep the queue non-empty until the filling thread detaches them.
+    ///
+    /// - returns: `false` if the queue's budget was exhausted, and the
+    ///   continuation was handled by its overflow policy instead.
+    @inlinable
+    @discardableResult
+    func notify(_ continuation: Deferred.Continuation) -> Bool {
+        switch self {
+        case .object(let storage):
+            let executed = storage.withUnsafeMutablePointers { (pointerToQueue, pointerToValue) -> Bool in
+                guard let existingValue = VariantState.load(pointerToValue), Deferred.isEmpty(pointerToQueue) else { return false }
+                continuation.execute(with: unsafeBitCast(existingValue, to: Value.self))
+                return true
+            }
+
+            return executed || enqueue(continuation)
+        case .native(let storage):
+            let executed = storage.withUnsafeMutablePointers { (pointerToHeader, pointerToValue) -> Bool in
+                guard VariantState.isFilled(&pointerToHeader.pointee.state), Deferred.isEmpty(&pointerToHeader.pointee.queue) else { return false }
+                continuation.execute(with: pointerToValue.pointee)
+                return true
+            }
+
+            return executed || enqueue(continuation)
+        case .inline(let bits):
+            continuation.execute(with: InlineValue.unpack(bits))
+            return true
+        case .filled(let value):
+            continuation.execute(with: value)
+            return true
+        }
+    }
+
+    /// The slow path of `notify(_:)`, which pushes the `continuation` and
+    /// drains the queue if the value was published in the meantime.
+    @usableFromInline
+    func enqueue(_ continuation: Deferred.Continuation) -> Bool {
+        switch self {
+        case .object(let storage):
+            return storage.withUnsafeMutablePointers { (pointerToQueue, pointerToValue) -> Bool in
+                guard Deferred.admit(continuation, to: pointerToQueue) else { return false }
+                if Deferred.push(continuation, to: pointerToQueue),
+                    let existingValue = unsafeBitCast(bnr_atomic_load(pointerToValue, .seq_cst), to: Value?.self) {
+                    Deferred.drain(from: pointerToQueue, continuingWith: existingValue, owner: storage)
+                }
+                return true
+            }
+        case .native(let storage):
+            return storage.withUnsafeMutablePointers { (pointerToHeader, pointerToValue) -> Bool in
+                guard Deferred.admit(continuation, to: &pointerToHeader.pointee.queue) else { return false }
+                if Deferred.push(continuation, to: &pointerToHeader.pointee.queue),
+                    FillState(rawValue: bnr_atomic_load(&pointerToHeader.pointee.state, .seq_cst)).contains(.filled) {
+                    Deferred.drain(from: &pointerToHeader.pointee.queue, continuingWith: pointerToValue.pointee, owner: storage)
+                }
+                return true
+            }
+        case .inline(let bits):
+            continuation.execute(with: InlineValue.unpack(bits))
+            return true
+        case .filled(let value):
+            continuation.execute(with: value)
+            return true
+        }
+    }
+
+    /// Adds each of `continuations` to the queue in order, or executes them
+    /// together if filled.
+    func notify(contentsOf continuations: [Deferred.Continuation]) {
         switch self {
         case .object(let storage):
             storage.withUnsafeMutablePointers { (pointerToQueue, pointerToValue) in
-                guard Deferred.push(continuation, to: pointerToQueue),
+                if let existingValue = unsafeBitCast(bnr_atomic_load(pointerToValue, .acquire), to: Value?.self), Deferred.isEmpty(pointerToQueue) {
+                    Deferred.execute(continuations, with: existingValue)
+                    return
+                }
+
+                let admitted = Deferred.admit(contentsOf: continuations, to: pointerToQueue)
+                guard Deferred.push(contentsOf: admitted, to: pointerToQueue),
                     let existingValue = unsafeBitCast(bnr_atomic_load(pointerToValue, .seq_cst), to: Value?.self) else { return }
-                Deferred.drain(from: pointerToQueue, continuingWith: existingValue)
+                Deferred.drain(from: pointerToQueue, continuingWith: existingValue, owner: storage)
             }
         case .native(let storage):
             storage.withUnsafeMutablePointers { (pointerToHeader, pointerToValue) in
-                guard Deferred.push(continuation, to: &pointerToHeader.pointee.queue),
-                    bnr_atomic_load(&pointerToHeader.pointee.isInitialized, .seq_cst) else { return }
-                Deferred.drain(from: &pointerToHeader.pointee.queue, continuingWith: pointerToValue.pointee)
+                if VariantState.isFilled(&pointerToHeader.pointee.state), Deferred.isEmpty(&pointerToHeader.pointee.queue) {
+                    Deferred.execute(continuations, with: pointerToValue.pointee)
+                    return
+                }
+
+                let admitted = Deferred.admit(contentsOf: continuations, to: &pointerToHeader.pointee.queue)
+                guard Deferred.push(contentsOf: admitted, to: &pointerToHeader.pointee.queue),
+                    FillState(rawValue: bnr_atomic_load(&pointerToHeader.pointee.state, .seq_cst)).contains(.filled) else { return }
+                Deferred.drain(from: &pointerToHeader.pointee.queue, continuingWith: pointerToValue.pointee, owner: storage)
             }
+        case .inline(let bits):
+            Deferred.execute(continuations, with: InlineValue.unpack(bits))
         case .filled(let value):
-            continuation.execute(with: value)
+            Deferred.execute(continuations, with: value)
         }
     }
 
+    @inlinable
     func load() -> Value? {
         switch self {
         case .object(let storage):
             return storage.withUnsafeMutablePointers { (_, pointerToValue) in
-                unsafeBitCast(bnr_atomic_load(pointerToValue, .relaxed), to: Value?.self)
+                unsafeBitCast(VariantState.load(pointerToValue), to: Value?.self)
             }
         case .native(let storage):
             return storage.withUnsafeMutablePointers { (pointerToHeader, pointerToValue) in
-                bnr_atomic_load(&pointerToHeader.pointee.isInitialized, .relaxed) ? pointerToValue.pointee : nil
+                VariantState.isFilled(&pointerToHeader.pointee.state) ? pointerToValue.pointee : nil
             }
+        case .inline(let bits):
+            return InlineValue.unpack(bits)
         case .filled(let value):
             return value
         }
     }
 
+    @inlinable
+    var isFilled: Bool {
+        switch self {
+        case .object(let storage):
+            return storage.withUnsafeMutablePointers { (_, pointerToValue) in
+                VariantState.isFilled(pointerToValue)
+            }
+        case .native(let storage):
+            return storage.withUnsafeMutablePointers { (pointerToHeader, _) in
+                VariantState.isFilled(&pointerToHeader.pointee.state)
+            }
+        case .inline, .filled:
+            return true
+        }
+    }
+
+    /// Calls `body` with a pointer to the stored value, if it has been
+    /// published.
+    ///
+    /// A native value is read in place. An object value is only a reference,
+    /// so it is loaded, costing a retain.
+    @inlinable
+    func withFilledValue<Result>(_ body: (UnsafePointer<Value>) throws -> Result) rethrows -> Result? {
+        switch self {
+        case .object(let storage):
+            let existingValue = storage.withUnsafeMutablePointers { (_, pointerToValue) in
+                VariantState.load(pointerToValue)
+            }
+            guard let value = existingValue else { return nil }
+            return try withUnsafePointer(to: unsafeBitCast(value, to: Value.self), body)
+        case .native(let storage):
+            return try storage.withUnsafeMutablePointers { (pointerToHeader, pointerToValue) -> Result? in
+                guard VariantState.isFilled(&pointerToHeader.pointee.state) else { return nil }
+                return try body(pointerToValue)
+            }
+        case .inline(let bits):
+            return try withUnsafePointer(to: InlineValue.unpack(bits) as Value, body)
+        case .filled(let value):
+            return try withUnsafePointer(to: value, body)
+        }
+    }
+
+    @inlinable
     func store(_ value: Value) -> Bool {
+        guard publish(value) else { return false }
+        withQueue { (pointerToQueue) in
+            Deferred.drain(from: pointerToQueue, continuingWith: value, owner: owner)
+        }
+        return true
+    }
+
+    /// The heap storage holding the queue, if any.
+    @usableFromInline
+    var owner: AnyObject? {
         switch self {
         case .object(let storage):
-            return storage.withUnsafeMutablePointers { (pointerToHeader, pointerToValue) -> Bool in
-                guard bnr_atomic_initialize_once(pointerToValue, unsafeBitCast(value, to: AnyObject.self)) else { return false }
-                Deferred.drain(from: pointerToHeader, continuingWith: value)
-                return true
+            return storage
+        case .native(let storage):
+            return storage
+        case .inline, .filled:
+            return nil
+        }
+    }
+
+    /// Makes `value` visible to readers without executing any continuations.
+    ///
+    /// - returns: Whether `value` was published. If so, the caller must drain
+    ///   the queue using `withQueue(_:)`.
+    @inlinable
+    func publish(_ value: Value) -> Bool {
+        switch self {
+        case .object(let storage):
+            return storage.withUnsafeMutablePointers { (_, pointerToValue) -> Bool in
+                VariantState.initialize(pointerToValue, to: unsafeBitCast(value, to: AnyObject.self))
             }
         case .native(let storage):
             return storage.withUnsafeMutablePointers { (pointerToHeader, pointerToValue) -> Bool in
-                guard bnr_atomic_initialize_once(&pointerToHeader.pointee.isInitialized, { pointerToValue.initialize(to: value) }) else { return false }
-                Deferred.drain(from: &pointerToHeader.pointee.queue, continuingWith: value)
+                guard VariantState.claim(&pointerToHeader.pointee.state) else { return false }
+                pointerToValue.initialize(to: value)
+                VariantState.markFilled(&pointerToHeader.pointee.state)
                 return true
             }
-        case .filled:
+        case .inline, .filled:
             return false
         }
     }
+
+    /// Calls `body` with the continuation queue, if there is one.
+    @inlinable
+    func withQueue(_ body: (UnsafeMutablePointer<Deferred.Queue>) -> Void) {
+        switch self {
+        case .object(let storage):
+            storage.withUnsafeMutablePointers { (pointerToQueue, _) in
+                body(pointerToQueue)
+            }
+        case .native(let storage):
+            storage.withUnsafeMutablePointers { (pointerToHeader, _) in
+                body(&pointerToHeader.pointee.queue)
+            }
+        case .inline, .filled:
+            break
+        }
+    }
+}
+
+/// Non-generic operations on the fill state of a `Deferred.Variant`.
+///
+/// `Variant`'s hot paths are inlined into, and specialized for, the calling
+/// module, which cannot see `CAtomics` or `FillState`. They call through
+/// here instead.
+@usableFromInline
+enum VariantState {
+    /// Whether a `NativeVariant` value has been published.
+    @usableFromInline
+    static func isFilled(_ state: UnsafeMutablePointer<Int32>) -> Bool {
+        return FillState(rawValue: bnr_atomic_load(state, .acquire)).contains(.filled)
+    }
+
+    /// Claims the right to write a `NativeVariant` value. Only the first
+    /// caller succeeds.
+    @usableFromInline
+    static func claim(_ state: UnsafeMutablePointer<Int32>) -> Bool {
+        let previous = FillState(rawValue: bnr_atomic_fetch_or(state, FillState.filling.rawValue, .acquire))
+        return previous.isDisjoint(with: [ .filling, .filled ])
+    }
+
+    /// Publishes a `NativeVariant` value written after `claim(_:)`, waking
+    /// any threads parked waiting for it.
+    @usableFromInline
+    static func markFilled(_ state: UnsafeMutablePointer<Int32>) {
+        let waiting = FillState(rawValue: bnr_atomic_fetch_or(state, FillState.filled.rawValue, .seq_cst))
+        #if os(Linux)
+        if waiting.hasWaiters {
+            bnr_futex_wake(state, .max)
+        }
+        #else
+        _ = waiting
+        #endif
+    }
+
+    /// Whether an `ObjectVariant` value has been published, without
+    /// retaining it.
+    @usableFromInline
+    static func isFilled(_ target: UnsafeMutablePointer<AnyObject?>) -> Bool {
+        return !bnr_atomic_is_nil(target, .acquire)
+    }
+
+    /// The published `ObjectVariant` value, if any.
+    @usableFromInline
+    static func load(_ target: UnsafeMutablePointer<AnyObject?>) -> AnyObject? {
+        return bnr_atomic_load(target, .acquire)
+    }
+
+    /// Publishes an `ObjectVariant` value, if none has been already.
+    @usableFromInline
+    static func initialize(_ target: UnsafeMutablePointer<AnyObject?>, to value: AnyObject) -> Bool {
+        return bnr_atomic_initialize_once(target, value)
+    }
+}
+
+#if os(Linux)
+extension Deferred.NativeVariant {
+    /// Blocks until the value is filled or `time` passes.
+    ///
+    /// Spins briefly, then parks the thread on the state word. Unlike the
+    /// general implementation, this needs neither a semaphore nor a
+    /// continuation; `store(_:)` only wakes the state word if any waiters
+    /// are counted in it.
+    ///
+    /// A waiter is only counted while it is parked. A deadline that has
+    /// already passed returns without parking or counting, so polling with
+    /// a zero timeout leaves no trace that a fill must wake.
+    func wait(until time: DispatchTime) -> Value? {
+        return withUnsafeMutablePointers { (pointerToHeader, pointerToValue) -> Value? in
+            for _ in 0 ..< 100 {
+                if FillState(rawValue: bnr_atomic_load(&pointerToHeader.pointee.state, .acquire)).contains(.filled) {
+                    return pointerToValue.pointee
+                }
+            }
+
+            while true {
+                let state = FillState(rawValue: bnr_atomic_load(&pointerToHeader.pointee.state, .acquire))
+                if state.contains(.filled) {
+                    return pointerToValue.pointee
+                }
+
+                var timeout: timespec?
+                if time != .distantFuture {
+                    let now = DispatchTime.now()
+                    guard now < time else { return nil }
+                    let remaining = time.uptimeNanoseconds - now.uptimeNanoseconds
+                    timeout = timespec(tv_sec: Int(remaining / 1_000_000_000), tv_nsec: Int(remaining % 1_000_000_000))
+                }
+
+                let parked = state.rawValue + FillState.waiter.rawValue
+                guard bnr_atomic_compare_and_swap(&pointerToHeader.pointee.state, state.rawValue, parked, .relaxed, .relaxed) else { continue }
+
+                if var timeout = timeout {
+                    bnr_futex_wait(&pointerToHeader.pointee.state, parked, &timeout)
+                } else {
+                    bnr_futex_wait(&pointerToHeader.pointee.state, parked, nil)
+                }
+
+                var current = bnr_atomic_load(&pointerToHeader.pointee.state, .relaxed)
+                while !bnr_atomic_compare_and_swap(&pointerToHeader.pointee.state, current, current - FillState.waiter.rawValue, .relaxed, .relaxed) {
+                    current = bnr_atomic_load(&pointerToHeader.pointee.state, .relaxed)
+                }
+            }
+        }
+    }
 }
+#endif
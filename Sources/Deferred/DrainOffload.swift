@@ -0,0 +1,82 @@
+//
+//  DrainOffload.swift
+//  Deferred
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+#if SWIFT_PACKAGE || (canImport(CAtomics) && !FORCE_PLAYGROUND_COMPATIBILITY)
+@_implementationOnly import CAtomics
+#endif
+
+/// An opt-in policy for submitting the handlers of a heavily-subscribed
+/// deferred from background threads.
+///
+/// Normally, the thread that fills a deferred submits every waiting handler
+/// to its executor before `fill(with:)` returns. With many thousands of
+/// handlers, that can stall the filling thread. When enabled, a fill that
+/// finds at least `threshold` waiting handlers instead hands them to a
+/// background thread and returns right away. The background thread splits
+/// them into runs of `chunkSize` in the order they were added, and submits
+/// the runs concurrently.
+///
+/// Within a run, each executor still receives handlers in the order they
+/// were added. Handlers in different runs may reach the same executor in any
+/// order, even on a serial queue.
+///
+/// The deferred is filled by the time the fill returns, so a handler added
+/// afterward is submitted right away, as for any filled deferred. It may run
+/// before handlers added ahead of the fill that the background threads have
+/// yet to submit.
+///
+/// Offloading is disabled by default.
+public enum DrainOffload {
+    /// The number of waiting handlers at which a fill offloads submitting
+    /// them, or `nil` to always submit them on the filling thread. Defaults
+    /// to `nil`.
+    ///
+    /// A fill checks at most this many handlers before deciding, so the time
+    /// it spends before returning is bounded by the threshold.
+    public static var threshold: Int? {
+        get {
+            return activeThreshold
+        }
+        set {
+            precondition(newValue.map { $0 > 0 } ?? true, "Threshold must be positive")
+            bnr_atomic_store(SharedState.instance.settings, newValue ?? 0, .relaxed)
+        }
+    }
+
+    /// The most handlers submitted together by one background thread.
+    /// Defaults to 4096.
+    public static var chunkSize: Int {
+        get {
+            return bnr_atomic_load(SharedState.instance.settings + 1, .relaxed)
+        }
+        set {
+            precondition(newValue > 0, "Chunk size must be positive")
+            bnr_atomic_store(SharedState.instance.settings + 1, newValue, .relaxed)
+        }
+    }
+}
+
+extension DrainOffload {
+    /// The threshold, or `nil` if offloading is disabled.
+    static var activeThreshold: Int? {
+        let threshold = bnr_atomic_load(SharedState.instance.settings, .relaxed)
+        return threshold > 0 ? threshold : nil
+    }
+
+    private final class SharedState {
+        static let instance = SharedState()
+
+        /// The threshold, with `0` meaning disabled, then the chunk size.
+        let settings = UnsafeMutablePointer<Int>.allocate(capacity: 2)
+
+        init() {
+            settings.initialize(to: 0)
+            (settings + 1).initialize(to: 4096)
+        }
+    }
+}
@@ -49,6 +49,14 @@ public protocol Executor: AnyObject {
 
     /// Execute the `workItem`.
     func submit(_ workItem: DispatchWorkItem)
+
+    /// Execute each of the `bodies`, in order.
+    ///
+    /// An executor that only ever runs one closure at a time may submit them
+    /// together to save on the overhead of submitting each one separately.
+    /// An executor that can run closures concurrently must not: the bodies
+    /// are independent handlers, and one may wait on work done by another.
+    func submit(contentsOf bodies: [() -> Void])
 }
 
 extension Executor {
@@ -56,6 +64,13 @@ extension Executor {
     public func submit(_ workItem: DispatchWorkItem) {
         submit(workItem.perform)
     }
+
+    /// By default, submits each of the closures in turn.
+    public func submit(contentsOf bodies: [() -> Void]) {
+        for body in bodies {
+            submit(body)
+        }
+    }
 }
 
 /// Dispatch queues invoke function bodies submitted to them serially in FIFO
@@ -86,6 +101,27 @@ extension DispatchQueue: Executor {
     public func submit(_ workItem: DispatchWorkItem) {
         async(execute: workItem)
     }
+
+    /// Submits the `bodies` as a single work item that calls each in order,
+    /// if the queue is the main queue.
+    ///
+    /// Dispatch does not say whether any other queue is serial, so for those
+    /// each body is submitted separately, and a concurrent queue may still
+    /// run them in parallel.
+    public func submit(contentsOf bodies: [() -> Void]) {
+        guard self === DispatchQueue.main else {
+            for body in bodies {
+                async(execute: body)
+            }
+            return
+        }
+
+        async {
+            for body in bodies {
+                body()
+            }
+        }
+    }
 }
 
 /// An operation queue manages a number of operation objects, making high
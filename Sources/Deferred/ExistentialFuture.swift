@@ -22,10 +22,18 @@ private class Box<Value> {
         fatalError()
     }
 
+    func upon<Owner: AnyObject>(_: Executor, weaklyOwnedBy _: Owner, execute _: @escaping(Owner, Value) -> Void) {
+        fatalError()
+    }
+
     func peek() -> Value? {
         fatalError()
     }
 
+    var isFilled: Bool {
+        fatalError()
+    }
+
     func wait(until _: DispatchTime) -> Value? {
         fatalError()
     }
@@ -42,10 +50,18 @@ private final class ForwardedTo<Future: FutureProtocol>: Box<Future.Value> {
         return base.upon(executor, execute: body)
     }
 
+    override func upon<Owner: AnyObject>(_ executor: Executor, weaklyOwnedBy owner: Owner, execute body: @escaping(Owner, Future.Value) -> Void) {
+        return base.upon(executor, weaklyOwnedBy: owner, execute: body)
+    }
+
     override func peek() -> Future.Value? {
         return base.peek()
     }
 
+    override var isFilled: Bool {
+        return base.isFilled
+    }
+
     override func wait(until time: DispatchTime) -> Future.Value? {
         return base.wait(until: time)
     }
@@ -64,27 +80,23 @@ private final class Always<Value>: Box<Value> {
         }
     }
 
-    override func peek() -> Value? {
-        return value
+    override func upon<Owner: AnyObject>(_ executor: Executor, weaklyOwnedBy owner: Owner, execute body: @escaping(Owner, Value) -> Void) {
+        executor.submit { [value, weak owner] in
+            guard let owner = owner else { return }
+            body(owner, value)
+        }
     }
 
-    override func wait(until _: DispatchTime) -> Value? {
+    override func peek() -> Value? {
         return value
     }
-}
-
-// Concrete future wrapper that will never get filled.
-private final class Never<Value>: Box<Value> {
-    override init() {}
-
-    override func upon(_: Executor, execute _: @escaping(Value) -> Void) {}
 
-    override func peek() -> Value? {
-        return nil
+    override var isFilled: Bool {
+        return true
     }
 
     override func wait(until _: DispatchTime) -> Value? {
-        return nil
+        return value
     }
 }
 
@@ -100,24 +112,48 @@ private final class Never<Value>: Box<Value> {
 /// - Publicly expose only the `FutureProtocol` aspect of a deferred value,
 ///   ensuring that only your implementation can fill the deferred value.
 public struct Future<Value>: FutureProtocol {
-    private let box: Box<Value>
+    /// How the future is represented. Constant futures whose value is small
+    /// and trivial, and futures that never fill, need no heap box.
+    ///
+    /// Most futures wrap a `Deferred`, so one is stored as-is, and calls go
+    /// straight to it rather than through a box's dynamic dispatch.
+    private enum Storage {
+        case box(Box<Value>)
+        case deferred(Deferred<Value>)
+        /// A value whose bits fit in `InlineValue.Bits`.
+        case inline(InlineValue.Bits)
+        case never
+    }
+
+    private let storage: Storage
 
     /// Create a future whose `upon(_:execute:)` methods forward to `base`.
     public init<Wrapped: FutureProtocol>(_ wrapped: Wrapped) where Wrapped.Value == Value {
         if let future = wrapped as? Future<Value> {
-            self.box = future.box
+            self.storage = future.storage
+        } else if let deferred = wrapped as? Deferred<Value> {
+            self.storage = .deferred(deferred)
         } else {
-            self.box = ForwardedTo(base: wrapped)
+            self.storage = .box(ForwardedTo(base: wrapped))
         }
     }
 
+    /// Create a future whose `upon(_:execute:)` methods forward to `deferred`.
+    public init(_ deferred: Deferred<Value>) {
+        self.storage = .deferred(deferred)
+    }
+
     /// Wrap and forward future as if it were always filled with `value`.
     public init(value: Value) {
-        self.box = Always(value: value)
+        if let bits = InlineValue.pack(value) {
+            self.storage = .inline(bits)
+        } else {
+            self.storage = .box(Always(value: value))
+        }
     }
 
     private init(never: ()) {
-        self.box = Never()
+        self.storage = .never
     }
 
     /// Create a future that will never get fulfilled.
@@ -127,19 +163,77 @@ public struct Future<Value>: FutureProtocol {
 
     /// Create a future having the same underlying future as `other`.
     public init(_ future: Future<Value>) {
-        self.box = future.box
+        self.storage = future.storage
     }
 
     public func upon(_ executor: Executor, execute body: @escaping(Value) -> Void) {
-        return box.upon(executor, execute: body)
+        switch storage {
+        case .box(let box):
+            box.upon(executor, execute: body)
+        case .deferred(let deferred):
+            deferred.upon(executor, execute: body)
+        case .inline(let bits):
+            executor.submit {
+                body(InlineValue.unpack(bits))
+            }
+        case .never:
+            break
+        }
+    }
+
+    public func upon<Owner: AnyObject>(_ executor: Executor, weaklyOwnedBy owner: Owner, execute body: @escaping(Owner, Value) -> Void) {
+        switch storage {
+        case .box(let box):
+            box.upon(executor, weaklyOwnedBy: owner, execute: body)
+        case .deferred(let deferred):
+            deferred.upon(executor, weaklyOwnedBy: owner, execute: body)
+        case .inline(let bits):
+            executor.submit { [weak owner] in
+                guard let owner = owner else { return }
+                body(owner, InlineValue.unpack(bits))
+            }
+        case .never:
+            break
+        }
     }
 
     public func peek() -> Value? {
-        return box.peek()
+        switch storage {
+        case .box(let box):
+            return box.peek()
+        case .deferred(let deferred):
+            return deferred.peek()
+        case .inline(let bits):
+            return InlineValue.unpack(bits)
+        case .never:
+            return nil
+        }
+    }
+
+    public var isFilled: Bool {
+        switch storage {
+        case .box(let box):
+            return box.isFilled
+        case .deferred(let deferred):
+            return deferred.isFilled
+        case .inline:
+            return true
+        case .never:
+            return false
+        }
     }
 
     public func wait(until time: DispatchTime) -> Value? {
-        return box.wait(until: time)
+        switch storage {
+        case .box(let box):
+            return box.wait(until: time)
+        case .deferred(let deferred):
+            return deferred.wait(until: time)
+        case .inline(let bits):
+            return InlineValue.unpack(bits)
+        case .never:
+            return nil
+        }
     }
 }
 
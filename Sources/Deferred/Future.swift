@@ -36,6 +36,14 @@ public protocol FutureProtocol: CustomDebugStringConvertible, CustomReflectable
     /// `executor` immediately.
     func upon(_ executor: Executor, execute body: @escaping(Value) -> Void)
 
+    /// Call some `body` closure once the value is determined, as long as
+    /// `owner` has not been deallocated by then.
+    ///
+    /// The future should only weakly reference `owner`. If `owner` is gone
+    /// when the value is determined, `body` should not be submitted to the
+    /// `executor` at all.
+    func upon<Owner: AnyObject>(_ executor: Executor, weaklyOwnedBy owner: Owner, execute body: @escaping(Owner, Value) -> Void)
+
     /// Checks for and returns a determined value.
     ///
     /// An implementation should use a "best effort" to return this value and
@@ -44,6 +52,11 @@ public protocol FutureProtocol: CustomDebugStringConvertible, CustomReflectable
     /// - returns: The determined value, if already filled, or `nil`.
     func peek() -> Value?
 
+    /// Checks whether the value is determined, without returning it.
+    ///
+    /// An implementation should avoid copying the value, if it can.
+    var isFilled: Bool { get }
+
     /// Waits synchronously for the value to become determined.
     ///
     /// If the value is already determined, the call returns immediately with
@@ -35,9 +35,12 @@ extension FutureProtocol {
     /// - returns: The new deferred value returned by the `transform`.
     public func andThen<NewFuture: FutureProtocol>(upon executor: Executor, start requestNextValue: @escaping(Value) -> NewFuture) -> Future<NewFuture.Value> {
         let deferred = Deferred<NewFuture.Value>()
-        upon(executor) {
-            requestNextValue($0).upon(executor) {
-                deferred.fill(with: $0)
+        let arena = DeferredArena.current
+        upon(executor) { (value) in
+            arena.withInstalled {
+                requestNextValue(value).upon(executor) {
+                    deferred.fill(with: $0)
+                }
             }
         }
         return Future(deferred)
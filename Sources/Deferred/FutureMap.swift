@@ -24,8 +24,9 @@ extension FutureProtocol {
     /// - returns: A new future that is filled once the receiver is determined.
     public func map<NewValue>(upon executor: Executor, transform: @escaping(Value) -> NewValue) -> Future<NewValue> {
         let deferred = Deferred<NewValue>()
-        upon(executor) {
-            deferred.fill(with: transform($0))
+        let arena = DeferredArena.current
+        upon(executor) { (value) in
+            deferred.fill(with: arena.withInstalled { transform(value) })
         }
         return Future(deferred)
     }
@@ -12,7 +12,7 @@ extension FutureProtocol {
         return wait(until: .now())
     }
 
-    /// Checks for a fulfilled future value.
+    /// By default, checks whether `peek` returns a value.
     public var isFilled: Bool {
         return peek() != nil
     }
@@ -29,4 +29,22 @@ extension FutureProtocol {
     public func upon(_ executor: PreferredExecutor = Self.defaultUponExecutor, execute body: @escaping(Value) -> Void) {
         upon(executor as Executor, execute: body)
     }
+
+    /// Call some `body` closure once the value is determined, as long as
+    /// `owner` has not been deallocated by then.
+    ///
+    /// `owner` is only weakly referenced, so the pending handler does not
+    /// keep it alive.
+    public func upon<Owner: AnyObject>(_ executor: Executor, weaklyOwnedBy owner: Owner, execute body: @escaping(Owner, Value) -> Void) {
+        upon(executor) { [weak owner] (value) in
+            guard let owner = owner else { return }
+            body(owner, value)
+        }
+    }
+
+    /// Call some `body` closure in the background once the value is
+    /// determined, as long as `owner` has not been deallocated by then.
+    public func upon<Owner: AnyObject>(_ executor: PreferredExecutor = Self.defaultUponExecutor, weaklyOwnedBy owner: Owner, execute body: @escaping(Owner, Value) -> Void) {
+        upon(executor as Executor, weaklyOwnedBy: owner, execute: body)
+    }
 }
@@ -0,0 +1,55 @@
+//
+//  HandlerPriority.swift
+//  Deferred
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+/// How urgently a handler should run relative to the other handlers waiting
+/// on the same deferred.
+///
+/// When a deferred is filled, handlers with a higher priority are submitted
+/// to their executors first. Handlers with the same priority are submitted in
+/// the order they were added. Handlers added without a priority are `normal`.
+///
+/// Priority only orders handlers that are waiting when the deferred is
+/// filled. A handler added after that is submitted right away, and a handler
+/// added at the same time as the fill may be submitted in the order it
+/// arrived.
+public struct HandlerPriority: RawRepresentable, Hashable, Comparable {
+    public let rawValue: Int8
+
+    public init(rawValue: Int8) {
+        self.rawValue = rawValue
+    }
+
+    /// For handlers whose results nobody is waiting on, such as warming a
+    /// cache.
+    public static let low = HandlerPriority(rawValue: -64)
+
+    /// The priority of handlers added without one.
+    public static let normal = HandlerPriority(rawValue: 0)
+
+    /// For handlers that unblock a user-facing response.
+    public static let high = HandlerPriority(rawValue: 64)
+
+    public static func < (lhs: HandlerPriority, rhs: HandlerPriority) -> Bool {
+        return lhs.rawValue < rhs.rawValue
+    }
+}
+
+extension Deferred {
+    /// Calls some `body` closure once the value is determined, ahead of any
+    /// waiting handlers with a lower `priority`.
+    ///
+    /// - parameter executor: A context for handling the `body` on fill.
+    /// - parameter priority: The order in which to submit `body` relative to
+    ///   other handlers when the deferred is filled.
+    /// - parameter body: A closure that uses the determined value.
+    /// - seealso: `HandlerPriority`
+    public func upon(_ executor: Executor, priority: HandlerPriority, execute body: @escaping(Value) -> Void) {
+        let continuation = Continuation(target: executor, priority: priority, handler: body)
+        variant.notify(continuation)
+    }
+}
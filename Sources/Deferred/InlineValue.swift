@@ -0,0 +1,67 @@
+//
+//  InlineValue.swift
+//  Deferred
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+/// Stores the value of a trivial type no larger than a word bitwise in
+/// `InlineValue.Bits`, if its bits fit there.
+///
+/// Constant futures and filled deferreds of such types, including `Void`,
+/// `Bool`, and small integers, keep their value in place rather than in a
+/// heap box. A trivial value has no references to retain or release, so
+/// copying its bits copies the value.
+///
+/// `Bits` is narrower than a word so that `Future` and `Deferred` stay one
+/// word in size. The enums storing it keep their case tags in the spare bits
+/// of their reference payloads, and a case with a full word of payload would
+/// leave none to spare. Values whose bits do not fit are boxed instead.
+@usableFromInline
+enum InlineValue {
+    #if arch(x86_64) || arch(arm64) || arch(powerpc64) || arch(powerpc64le) || arch(s390x)
+    /// The low half of a word, leaving the spare bits of the high half.
+    @usableFromInline
+    typealias Bits = UInt32
+    #else
+    /// A 32-bit word has no bits to spare, so only values whose bits are all
+    /// zero are stored inline.
+    @usableFromInline
+    typealias Bits = Void
+    #endif
+
+    /// Whether values of `type` might be stored inline.
+    @inlinable
+    static func canStore<Value>(_ type: Value.Type) -> Bool {
+        return _isPOD(type) && MemoryLayout<Value>.size <= MemoryLayout<UInt>.size && MemoryLayout<Value>.alignment <= MemoryLayout<UInt>.alignment
+    }
+
+    /// Copies the bits of `value`, or returns `nil` if they do not fit.
+    @inlinable
+    static func pack<Value>(_ value: Value) -> Bits? {
+        guard canStore(Value.self) else { return nil }
+        var word: UInt = 0
+        withUnsafeMutableBytes(of: &word) { (buffer) in
+            buffer.storeBytes(of: value, as: Value.self)
+        }
+        #if arch(x86_64) || arch(arm64) || arch(powerpc64) || arch(powerpc64le) || arch(s390x)
+        return Bits(exactly: word)
+        #else
+        return word == 0 ? () : nil
+        #endif
+    }
+
+    /// Reads back a value stored by `pack(_:)`.
+    @inlinable
+    static func unpack<Value>(_ bits: Bits, as _: Value.Type = Value.self) -> Value {
+        #if arch(x86_64) || arch(arm64) || arch(powerpc64) || arch(powerpc64le) || arch(s390x)
+        let word = UInt(bits)
+        #else
+        let word: UInt = 0
+        #endif
+        return withUnsafeBytes(of: word) { (buffer) in
+            buffer.load(as: Value.self)
+        }
+    }
+}
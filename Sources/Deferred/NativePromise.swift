@@ -0,0 +1,193 @@
+//
+//  NativePromise.swift
+//  Deferred
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+#if SWIFT_PACKAGE || (canImport(CAtomics) && !FORCE_PLAYGROUND_COMPATIBILITY)
+import Dispatch
+import Foundation
+@_implementationOnly import CAtomics
+
+/// The value of a promise filled by native code using the C API in
+/// `CPromise.h`.
+public enum NativePayload {
+    /// The bytes passed to `bnr_promise_fill_bytes`.
+    case bytes(NativeBytes)
+    /// The pointer passed to `bnr_promise_fill_pointer`.
+    case pointer(UnsafeMutableRawPointer?)
+}
+
+/// The bytes a native promise was filled with.
+///
+/// The buffer that `bnr_promise_fill_bytes` copied the bytes into is taken
+/// over as-is, rather than being copied again, and is freed along with this
+/// instance.
+public final class NativeBytes: RandomAccessCollection {
+    private let base: UnsafeRawPointer?
+    public let count: Int
+
+    fileprivate init(base: UnsafeRawPointer?, count: Int) {
+        self.base = base
+        self.count = count
+    }
+
+    deinit {
+        free(UnsafeMutableRawPointer(mutating: base))
+    }
+
+    public var startIndex: Int {
+        return 0
+    }
+
+    public var endIndex: Int {
+        return count
+    }
+
+    public subscript(position: Int) -> UInt8 {
+        precondition(indices.contains(position), "Index out of range")
+        return base.unsafelyUnwrapped.load(fromByteOffset: position, as: UInt8.self)
+    }
+
+    /// Calls `body` with the bytes in place.
+    public func withUnsafeBytes<Result>(_ body: (UnsafeRawBufferPointer) throws -> Result) rethrows -> Result {
+        return try body(UnsafeRawBufferPointer(start: base, count: count))
+    }
+}
+
+/// A future determined by native code filling a `bnr_promise_t`.
+///
+/// Native code fills the promise from any thread with one atomic publish.
+/// The future picks up the payload lazily, the first time it is read after
+/// the fill.
+///
+/// Only once a handler is added, or a thread waits, does the future register
+/// with the promise to be told of the fill. Until then, filling the promise
+/// never calls into Swift.
+public struct NativeFuture: FutureProtocol {
+    private let storage: Storage
+
+    /// Creates a future that is determined when native code fills `handle`.
+    ///
+    /// `handle` must be a `bnr_promise_t`, such as one returned by
+    /// `bnr_promise_create`. The future retains it, so the caller's reference
+    /// is not consumed.
+    public init(nativePromise handle: OpaquePointer) {
+        let promise = UnsafeMutablePointer<bnr_promise_s>(handle)
+        bnr_promise_retain(promise)
+        storage = Storage(promise: promise)
+    }
+
+    /// Creates an unfilled future along with a native promise that fills it.
+    ///
+    /// Pass `handle`, a `bnr_promise_t`, to native code, which must fill it
+    /// and then call `bnr_promise_release` to release it.
+    public static func make() -> (future: NativeFuture, handle: OpaquePointer) {
+        guard let promise = bnr_promise_create() else {
+            preconditionFailure("Could not allocate a native promise")
+        }
+        return (NativeFuture(nativePromise: OpaquePointer(promise)), OpaquePointer(promise))
+    }
+
+    public func upon(_ executor: Executor, execute body: @escaping(NativePayload) -> Void) {
+        storage.deferred.upon(executor, execute: body)
+        storage.pickUpOrRegister()
+    }
+
+    public func upon<Owner: AnyObject>(_ executor: Executor, weaklyOwnedBy owner: Owner, execute body: @escaping(Owner, NativePayload) -> Void) {
+        storage.deferred.upon(executor, weaklyOwnedBy: owner, execute: body)
+        storage.pickUpOrRegister()
+    }
+
+    public func peek() -> NativePayload? {
+        storage.pickUp()
+        return storage.deferred.peek()
+    }
+
+    public var isFilled: Bool {
+        return storage.pickUp()
+    }
+
+    public func wait(until time: DispatchTime) -> NativePayload? {
+        storage.pickUpOrRegister()
+        return storage.deferred.wait(until: time)
+    }
+}
+
+extension NativeFuture {
+    /// A promise, and the deferred its payload is picked up into.
+    private final class Storage {
+        let promise: UnsafeMutablePointer<bnr_promise_s>
+        let deferred = Deferred<NativePayload>()
+
+        init(promise: UnsafeMutablePointer<bnr_promise_s>) {
+            self.promise = promise
+        }
+
+        deinit {
+            bnr_promise_release(promise)
+        }
+
+        /// Fills the deferred if the promise has been filled.
+        ///
+        /// - returns: Whether the deferred is filled. It may not be yet if
+        ///   another thread has taken the payload but not finished filling it.
+        @discardableResult
+        func pickUp() -> Bool {
+            if deferred.isFilled {
+                return true
+            }
+            return NativeFuture.pickUp(from: promise, into: deferred) || deferred.isFilled
+        }
+
+        /// Picks up the payload, or registers to pick it up once native code
+        /// fills the promise.
+        ///
+        /// The handler retains only the deferred, not this storage, so the
+        /// promise is released along with the last copy of the future. If it
+        /// was never filled, that releases the deferred and its handlers.
+        func pickUpOrRegister() {
+            guard !pickUp() else { return }
+            let context = Unmanaged.passRetained(Waiter(deferred)).toOpaque()
+            if !bnr_promise_set_handler(promise, fillFromNativePromise, context) {
+                Unmanaged<Waiter>.fromOpaque(context).release()
+            }
+        }
+    }
+
+    /// The context registered with a native promise.
+    fileprivate final class Waiter {
+        let deferred: Deferred<NativePayload>
+
+        init(_ deferred: Deferred<NativePayload>) {
+            self.deferred = deferred
+        }
+    }
+
+    /// Takes the payload of `promise`, if filled, and fills `deferred` with it
+    /// without copying it again.
+    ///
+    /// - returns: Whether the payload was taken.
+    fileprivate static func pickUp(from promise: UnsafeMutablePointer<bnr_promise_s>, into deferred: Deferred<NativePayload>) -> Bool {
+        var payload = bnr_promise_payload_t()
+        guard bnr_promise_take(promise, &payload) else { return false }
+        if payload.is_pointer {
+            deferred.fill(with: .pointer(UnsafeMutableRawPointer(mutating: payload.data)))
+        } else {
+            deferred.fill(with: .bytes(NativeBytes(base: payload.data, count: payload.length)))
+        }
+        return true
+    }
+}
+
+/// Picks up the payload of a filled native promise, or releases the waiter
+/// if the promise was abandoned.
+private func fillFromNativePromise(_ context: UnsafeMutableRawPointer?, _ promise: UnsafeMutablePointer<bnr_promise_s>?) {
+    guard let context = context else { return }
+    let waiter = Unmanaged<NativeFuture.Waiter>.fromOpaque(context).takeRetainedValue()
+    guard let promise = promise else { return }
+    _ = NativeFuture.pickUp(from: promise, into: waiter.deferred)
+}
+#endif
@@ -0,0 +1,209 @@
+//
+//  OneShot.swift
+//  Deferred
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+#if SWIFT_PACKAGE || (canImport(CAtomics) && !FORCE_PLAYGROUND_COMPATIBILITY)
+@_implementationOnly import CAtomics
+#endif
+
+/// A value that is determined once and handed to exactly one consumer.
+///
+/// Most promises have a single consumer. A `Deferred` supports any number of
+/// handlers, and keeps its value to give a copy to each one. A one-shot
+/// instead has a single state word and room for one handler, and moves its
+/// value out to the consumer rather than copying it. With
+/// `upon(_:consuming:)`, the handler holds the only reference to the value,
+/// so a large copy-on-write buffer can be mutated without being copied.
+///
+/// A one-shot is consumed by `upon(_:execute:)`, `upon(_:consuming:)`, by
+/// `take()` once filled, or by converting it to a `Future`. Consuming it more
+/// than once is a programmer error.
+public struct OneShot<Value> {
+    fileprivate let storage: Storage
+
+    /// Creates an unfilled one-shot.
+    public init() {
+        storage = .create()
+    }
+
+    /// Determines the one-shot with `value`.
+    ///
+    /// If the consumer is already waiting, it is handed `value` right away.
+    ///
+    /// - returns: Whether the one-shot was filled with `value`.
+    @discardableResult
+    public func fill(with value: Value) -> Bool {
+        return storage.store(value)
+    }
+
+    /// Calls some `body` closure with the value once it is determined,
+    /// consuming the one-shot.
+    ///
+    /// - parameter executor: A context for handling the `body` on fill.
+    /// - parameter body: A closure that takes ownership of the value.
+    public func upon(_ executor: Executor, execute body: @escaping(Value) -> Void) {
+        storage.notify(executor) { (value: inout Value) in
+            body(value)
+        }
+    }
+
+    /// Calls some `body` closure with the value once it is determined,
+    /// consuming the one-shot.
+    ///
+    /// The value is moved out of the one-shot for `body`, so once the filler
+    /// has let go of it, `body` may mutate it in place without copying.
+    ///
+    /// - parameter executor: A context for handling the `body` on fill.
+    /// - parameter body: A closure that takes ownership of the value.
+    public func upon(_ executor: Executor, consuming body: @escaping(inout Value) -> Void) {
+        storage.notify(executor, handler: body)
+    }
+
+    /// Removes and returns the value, if determined, consuming the one-shot.
+    ///
+    /// - returns: The value, or `nil` if the one-shot is not yet filled, in
+    ///   which case it is not consumed.
+    public func take() -> Value? {
+        return storage.take()
+    }
+
+    /// Whether the value is determined, even if it was already consumed.
+    public var isFilled: Bool {
+        return storage.isFilled
+    }
+}
+
+extension Future {
+    /// Creates a future that is filled by the one-shot, consuming it.
+    ///
+    /// The value is moved into the future, which may then hand copies of it to
+    /// any number of handlers.
+    public init(_ oneShot: OneShot<Value>) {
+        let deferred = Deferred<Value>()
+        oneShot.storage.notify(nil) { (value) in
+            deferred.fill(with: value)
+        }
+        self.init(deferred)
+    }
+}
+
+extension OneShot {
+    /// The tail-allocated header used for `Storage`.
+    struct Header {
+        /// The progress of the one-shot, as described by `OneShotState`.
+        var state = 0
+        /// The consumer, written once before `OneShotState.awaiting` is set.
+        var target: Executor?
+        var handler: ((inout Value) -> Void)?
+    }
+
+    /// Heap storage for a one-shot.
+    ///
+    /// The producer stores the value and then sets `filled`; the consumer
+    /// stores its continuation and then sets `awaiting`. Whichever of them
+    /// sets its bit second sees the other's, and performs the hand-off.
+    final class Storage: ManagedBuffer<Header, Value> {
+        static func create() -> Storage {
+            let storage = super.create(minimumCapacity: 1, makingHeaderWith: { _ in Header() })
+            return unsafeDowncast(storage, to: Storage.self)
+        }
+
+        deinit {
+            withUnsafeMutablePointers { (pointerToHeader, pointerToValue) in
+                if pointerToHeader.pointee.state & (OneShotState.filled | OneShotState.consumed) == OneShotState.filled {
+                    pointerToValue.deinitialize(count: 1)
+                }
+            }
+        }
+
+        var isFilled: Bool {
+            return withUnsafeMutablePointers { (pointerToHeader, _) in
+                bnr_atomic_load(&pointerToHeader.pointee.state, .acquire) & OneShotState.filled != 0
+            }
+        }
+
+        func store(_ value: Value) -> Bool {
+            return withUnsafeMutablePointers { (pointerToHeader, pointerToValue) -> Bool in
+                guard bnr_atomic_fetch_or(&pointerToHeader.pointee.state, OneShotState.filling, .acquire) & OneShotState.filling == 0 else { return false }
+
+                pointerToValue.initialize(to: value)
+                let state = bnr_atomic_fetch_or(&pointerToHeader.pointee.state, OneShotState.filled, .acq_rel)
+                if state & OneShotState.awaiting != 0 {
+                    handOff(pointerToHeader)
+                }
+                return true
+            }
+        }
+
+        func notify(_ target: Executor?, handler: @escaping(inout Value) -> Void) {
+            withUnsafeMutablePointers { (pointerToHeader, pointerToValue) in
+                claimConsumer(pointerToHeader)
+
+                pointerToHeader.pointee.target = target
+                pointerToHeader.pointee.handler = handler
+                let state = bnr_atomic_fetch_or(&pointerToHeader.pointee.state, OneShotState.awaiting, .acq_rel)
+                if state & OneShotState.filled != 0 {
+                    handOff(pointerToHeader)
+                }
+            }
+        }
+
+        func take() -> Value? {
+            return withUnsafeMutablePointers { (pointerToHeader, pointerToValue) -> Value? in
+                guard bnr_atomic_load(&pointerToHeader.pointee.state, .acquire) & OneShotState.filled != 0 else { return nil }
+                claimConsumer(pointerToHeader)
+                bnr_atomic_fetch_or(&pointerToHeader.pointee.state, OneShotState.consumed, .relaxed)
+                return pointerToValue.move()
+            }
+        }
+
+        private func claimConsumer(_ pointerToHeader: UnsafeMutablePointer<Header>) {
+            let state = bnr_atomic_fetch_or(&pointerToHeader.pointee.state, OneShotState.consumer, .relaxed)
+            precondition(state & OneShotState.consumer == 0, "A one-shot may only be consumed once")
+        }
+
+        /// Submits the consumer, which moves the value out once it runs. Only
+        /// called by whichever side completed the state second, so the value
+        /// and handler are both in place and nothing else touches them.
+        private func handOff(_ pointerToHeader: UnsafeMutablePointer<Header>) {
+            guard let handler = pointerToHeader.pointee.handler else { return }
+            let target = pointerToHeader.pointee.target
+            pointerToHeader.pointee.target = nil
+            pointerToHeader.pointee.handler = nil
+
+            // Moving the value on the executor, rather than here, keeps this
+            // the only reference to it when the handler runs.
+            let consume = {
+                var value = self.withUnsafeMutablePointers { (pointerToHeader, pointerToValue) -> Value in
+                    bnr_atomic_fetch_or(&pointerToHeader.pointee.state, OneShotState.consumed, .relaxed)
+                    return pointerToValue.move()
+                }
+                handler(&value)
+            }
+
+            if let target = target {
+                target.submit(consume)
+            } else {
+                consume()
+            }
+        }
+    }
+}
+
+/// The layout of a one-shot's state word.
+private enum OneShotState {
+    /// A filler has won the race and is storing its value.
+    static let filling = 1 << 0
+    /// The value is stored and may be read.
+    static let filled = 1 << 1
+    /// A consumer has claimed the one-shot.
+    static let consumer = 1 << 2
+    /// The consumer's continuation is stored.
+    static let awaiting = 1 << 3
+    /// The value has been moved out to the consumer.
+    static let consumed = 1 << 4
+}
@@ -0,0 +1,231 @@
+//
+//  PromisePool.swift
+//  Deferred
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+import Dispatch
+
+#if SWIFT_PACKAGE || (canImport(CAtomics) && !FORCE_PLAYGROUND_COMPATIBILITY)
+@_implementationOnly import CAtomics
+#endif
+
+/// A source of reusable promises, for creating and discarding many
+/// short-lived deferred values without allocating each one.
+///
+/// A promise handed out by the pool behaves like a `Deferred`. Once you are
+/// done with it, `recycle(_:)` returns its storage to the pool in an unfilled
+/// state, and a later call to `makePromise()` reuses it.
+///
+/// Each use of the storage is a new generation. Copies of a promise that
+/// was recycled become stale, and never observe the value of a later
+/// generation: they cannot be filled, never call their handlers, and
+/// return `nil` from `peek()` and `wait(until:)`.
+public final class PromisePool<Value> {
+    private let limit: Int
+    private let lock = NativeLock()
+    private var freeStorage = [PooledPromise<Value>.Storage]()
+
+    /// Creates a pool that keeps at most `limit` recycled promises.
+    public init(limit: Int = 64) {
+        precondition(limit >= 0, "Pool must have a non-negative limit")
+        self.limit = limit
+    }
+
+    /// Returns an unfilled promise, reusing recycled storage if there is any.
+    public func makePromise() -> PooledPromise<Value> {
+        let storage = lock.withWriteLock { freeStorage.popLast() } ?? .create()
+        return PooledPromise(storage: storage, generation: storage.generation)
+    }
+
+    /// Resets the storage for `promise`, making it and every copy of it stale,
+    /// and keeps the storage to be reused.
+    ///
+    /// Handlers that were added to an unfilled promise are released without
+    /// being called, as if it had been deallocated.
+    ///
+    /// - returns: Whether the storage was recycled. This fails if `promise`
+    ///   is already stale, is being filled, or is otherwise in use at the
+    ///   same time, such as by a handler called inline during a fill.
+    @discardableResult
+    public func recycle(_ promise: PooledPromise<Value>) -> Bool {
+        guard promise.storage.reset(from: promise.generation) else { return false }
+        lock.withWriteLock {
+            if freeStorage.count < limit {
+                freeStorage.append(promise.storage)
+            }
+        }
+        return true
+    }
+}
+
+/// A deferred value whose storage belongs to a `PromisePool`.
+public struct PooledPromise<Value> {
+    fileprivate let storage: Storage
+    fileprivate let generation: Int
+
+    /// Whether the promise has been recycled since it was handed out.
+    public var isStale: Bool {
+        return storage.generation != generation
+    }
+
+    /// Determines the promise with `value`.
+    ///
+    /// Filling a deferred value should usually be attempted only once.
+    ///
+    /// - returns: Whether the promise was fulfilled with `value`. Always
+    ///   `false` if the promise is stale.
+    @discardableResult
+    public func fill(with value: Value) -> Bool {
+        return storage.withPinned(generation) { (pointerToHeader, pointerToValue) -> Bool in
+            let state = bnr_atomic_fetch_or(&pointerToHeader.pointee.state, PooledState.filling, .acquire)
+            guard state & (PooledState.filling | PooledState.filled) == 0 else { return false }
+
+            pointerToValue.initialize(to: value)
+            bnr_atomic_fetch_or(&pointerToHeader.pointee.state, PooledState.filled, .seq_cst)
+            Deferred<Value>.drain(from: &pointerToHeader.pointee.queue, continuingWith: value)
+            return true
+        } ?? false
+    }
+}
+
+extension PooledPromise: FutureProtocol {
+    public func upon(_ executor: Executor, execute body: @escaping(Value) -> Void) {
+        notify(Deferred<Value>.Continuation(target: executor, handler: body))
+    }
+
+    public func peek() -> Value? {
+        return storage.withPinned(generation) { (pointerToHeader, pointerToValue) -> Value? in
+            PooledState.isFilled(&pointerToHeader.pointee.state, .acquire) ? pointerToValue.pointee : nil
+        } ?? nil
+    }
+
+    public var isFilled: Bool {
+        return storage.withPinned(generation) { (pointerToHeader, _) in
+            PooledState.isFilled(&pointerToHeader.pointee.state, .acquire)
+        } ?? false
+    }
+
+    public func wait(until time: DispatchTime) -> Value? {
+        let semaphore = DispatchSemaphore(value: 0)
+        var result: Value?
+
+        let continuation = Deferred<Value>.Continuation(target: nil) { (value) in
+            result = value
+            semaphore.signal()
+        }
+
+        guard notify(continuation), case .success = semaphore.wait(timeout: time) else { return nil }
+        return result
+    }
+
+    /// Adds the `continuation` to the queue, or executes it if filled. Mirrors
+    /// `Deferred.Variant.notify(_:)`.
+    ///
+    /// - returns: `false` if the promise is stale.
+    @discardableResult
+    private func notify(_ continuation: Deferred<Value>.Continuation) -> Bool {
+        return storage.withPinned(generation) { (pointerToHeader, pointerToValue) -> Void in
+            if PooledState.isFilled(&pointerToHeader.pointee.state, .acquire), Deferred<Value>.isEmpty(&pointerToHeader.pointee.queue) {
+                continuation.execute(with: pointerToValue.pointee)
+                return
+            }
+
+            guard Deferred<Value>.push(continuation, to: &pointerToHeader.pointee.queue),
+                PooledState.isFilled(&pointerToHeader.pointee.state, .seq_cst) else { return }
+            Deferred<Value>.drain(from: &pointerToHeader.pointee.queue, continuingWith: pointerToValue.pointee)
+        } != nil
+    }
+}
+
+extension PooledPromise {
+    /// The tail-allocated header used for `Storage`.
+    struct Header {
+        /// The generation, the number of operations in progress, and the fill
+        /// state, laid out as described by `PooledState`.
+        var state = 0
+        var queue = Deferred<Value>.Queue()
+    }
+
+    /// Heap storage for a pooled promise.
+    ///
+    /// Every operation through a handle first pins the storage by adding to
+    /// the count in the state word, as long as the generation still matches.
+    /// Resetting only succeeds while nothing is pinned, and moves to the next
+    /// generation in the same step, so no stale handle can reach the queue
+    /// or value afterwards.
+    final class Storage: ManagedBuffer<Header, Value> {
+        static func create() -> Storage {
+            let storage = super.create(minimumCapacity: 1, makingHeaderWith: { _ in Header() })
+            return unsafeDowncast(storage, to: Storage.self)
+        }
+
+        deinit {
+            withUnsafeMutablePointers { (pointerToHeader, pointerToValue) in
+                if PooledState.isFilled(&pointerToHeader.pointee.state, .relaxed) {
+                    pointerToValue.deinitialize(count: 1)
+                }
+            }
+        }
+
+        var generation: Int {
+            return withUnsafeMutablePointers { (pointerToHeader, _) in
+                bnr_atomic_load(&pointerToHeader.pointee.state, .relaxed) >> PooledState.generationShift
+            }
+        }
+
+        /// Calls `body` while pinned, if the storage is still on `generation`.
+        func withPinned<Return>(_ generation: Int, _ body: (UnsafeMutablePointer<Header>, UnsafeMutablePointer<Value>) throws -> Return) rethrows -> Return? {
+            return try withUnsafeMutablePointers { (pointerToHeader, pointerToValue) -> Return? in
+                while true {
+                    let state = bnr_atomic_load(&pointerToHeader.pointee.state, .relaxed)
+                    guard state >> PooledState.generationShift == generation else { return nil }
+                    precondition(state & PooledState.pinMask != PooledState.pinMask, "Too many concurrent operations on a pooled promise")
+                    if bnr_atomic_compare_and_swap(&pointerToHeader.pointee.state, state, state + PooledState.pin, .acquire, .relaxed) {
+                        break
+                    }
+                }
+
+                defer { bnr_atomic_fetch_add(&pointerToHeader.pointee.state, -PooledState.pin, .release) }
+                return try body(pointerToHeader, pointerToValue)
+            }
+        }
+
+        /// Moves from `generation` to the next, unfilled, if nothing is pinned.
+        func reset(from generation: Int) -> Bool {
+            return withUnsafeMutablePointers { (pointerToHeader, pointerToValue) -> Bool in
+                let state = bnr_atomic_load(&pointerToHeader.pointee.state, .relaxed)
+                let fillState = state & (PooledState.filling | PooledState.filled)
+                guard state >> PooledState.generationShift == generation, state & PooledState.pinMask == 0,
+                    fillState != PooledState.filling,
+                    bnr_atomic_compare_and_swap(&pointerToHeader.pointee.state, state, (generation + 1) << PooledState.generationShift, .acq_rel, .relaxed) else { return false }
+
+                // Nothing can pin the new generation until it is handed out.
+                if state & PooledState.filled != 0 {
+                    pointerToValue.deinitialize(count: 1)
+                }
+                pointerToHeader.pointee.queue = Deferred<Value>.Queue()
+                return true
+            }
+        }
+    }
+}
+
+/// The layout of a pooled promise's state word.
+private enum PooledState {
+    /// A filler has won the race and is storing its value.
+    static let filling = 1 << 0
+    /// The value is stored and may be read.
+    static let filled = 1 << 1
+    /// One operation in progress, counted in the bits of `pinMask`.
+    static let pin = 1 << 2
+    static let pinMask = 0xFFFF << 2
+    /// The generation is stored in the remaining high bits.
+    static let generationShift = 18
+
+    static func isFilled(_ state: UnsafeMutablePointer<Int>, _ order: bnr_atomic_memory_order_t) -> Bool {
+        return bnr_atomic_load(state, order) & filled != 0
+    }
+}
@@ -44,3 +44,39 @@ extension Deferred where Value: Either, Value.Right == Void {
         return fill(with: Value(right: ()))
     }
 }
+
+extension DeferredSlab.Slot: TaskProtocol where Value: Either {
+    /// Completes the slot with a successful `value`.
+    ///
+    /// - seealso: `DeferredSlab.Slot.fill(with:)`
+    @discardableResult
+    public func succeed(with value: Success) -> Bool {
+        return fill(with: Value(right: value))
+    }
+
+    /// Completes the slot with a failed `error`.
+    ///
+    /// - seealso: `DeferredSlab.Slot.fill(with:)`
+    @discardableResult
+    public func fail(with error: Failure) -> Bool {
+        return fill(with: Value(left: error))
+    }
+}
+
+extension PooledPromise: TaskProtocol where Value: Either {
+    /// Completes the promise with a successful `value`.
+    ///
+    /// - seealso: `PooledPromise.fill(with:)`
+    @discardableResult
+    public func succeed(with value: Success) -> Bool {
+        return fill(with: Value(right: value))
+    }
+
+    /// Completes the promise with a failed `error`.
+    ///
+    /// - seealso: `PooledPromise.fill(with:)`
+    @discardableResult
+    public func fail(with error: Failure) -> Bool {
+        return fill(with: Value(left: error))
+    }
+}
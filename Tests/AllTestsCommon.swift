@@ -9,6 +9,9 @@
 import XCTest
 import Dispatch
 import Deferred
+#if canImport(Darwin)
+import Darwin
+#endif
 
 enum TestError: Error, CustomStringConvertible, CustomDebugStringConvertible {
     case first
@@ -69,6 +72,18 @@ extension XCTestCase {
     }
 }
 
+#if canImport(Darwin)
+/// The number of heap blocks currently allocated across all malloc zones.
+///
+/// Comparing the count before and after some work measures how many
+/// allocations that work retained.
+func liveAllocationCount() -> Int {
+    var statistics = malloc_statistics_t()
+    malloc_zone_statistics(nil, &statistics)
+    return Int(statistics.blocks_in_use)
+}
+#endif
+
 extension FutureProtocol {
     /// Waits for the value to become determined, then returns it.
     ///
@@ -90,6 +105,13 @@ extension FutureProtocol {
 
 // MARK: -
 
+/// Executes submitted work right away, on the calling thread.
+final class InlineExecutor: Executor {
+    func submit(_ body: @escaping() -> Void) {
+        body()
+    }
+}
+
 private class CountingExecutor: Executor {
     let submitCount = Protected(initialValue: 0)
 
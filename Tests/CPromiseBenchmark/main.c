@@ -0,0 +1,131 @@
+//
+//  main.c
+//  CPromiseBenchmark
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+//  Measures filling promises from native code, the way a C library finishing
+//  work on its own threads would.
+//
+//  Run in release: `swift run -c release CPromiseBenchmark`.
+
+#include <CPromise.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <time.h>
+
+static const long iteration_count = 1000000;
+
+static void take_filled(void *context, bnr_promise_t promise) {
+    bnr_promise_payload_t payload;
+    if (promise && bnr_promise_take(promise, &payload)) {
+        *(long *)context += 1;
+    }
+}
+
+static double elapsed_nanoseconds(struct timespec start, struct timespec end) {
+    return (double)(end.tv_sec - start.tv_sec) * 1e9 + (double)(end.tv_nsec - start.tv_nsec);
+}
+
+static void report(const char *name, struct timespec start, struct timespec end) {
+    printf("%-40s %8.1f ns/op\n", name, elapsed_nanoseconds(start, end) / (double)iteration_count);
+}
+
+static void benchmark_fill_pointer(void) {
+    long filled = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < iteration_count; i++) {
+        bnr_promise_t promise = bnr_promise_create();
+        filled += bnr_promise_fill_pointer(promise, &filled);
+        bnr_promise_release(promise);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (filled != iteration_count) {
+        fprintf(stderr, "expected every promise to be filled\n");
+    }
+    report("fill pointer", start, end);
+}
+
+static void benchmark_fill_pointer_with_handler(void) {
+    long taken = 0;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < iteration_count; i++) {
+        bnr_promise_t promise = bnr_promise_create();
+        bnr_promise_set_handler(promise, take_filled, &taken);
+        bnr_promise_fill_pointer(promise, &taken);
+        bnr_promise_release(promise);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (taken != iteration_count) {
+        fprintf(stderr, "expected every handler to take its payload\n");
+    }
+    report("fill pointer, handler already set", start, end);
+}
+
+static void benchmark_fill_bytes_then_take(void) {
+    long taken = 0;
+    const char bytes[64] = { 0 };
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (long i = 0; i < iteration_count; i++) {
+        bnr_promise_t promise = bnr_promise_create();
+        bnr_promise_fill_bytes(promise, bytes, sizeof(bytes));
+        bnr_promise_payload_t payload;
+        if (bnr_promise_take(promise, &payload)) {
+            taken += (long)payload.length;
+            free((void *)payload.data);
+        }
+        bnr_promise_release(promise);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    if (taken != iteration_count * (long)sizeof(bytes)) {
+        fprintf(stderr, "expected every payload to be taken\n");
+    }
+    report("fill 64 bytes, then take", start, end);
+}
+
+static bnr_promise_t *shared_promises;
+
+static void *fill_all(void *unused) {
+    (void)unused;
+    for (long i = 0; i < iteration_count; i++) {
+        bnr_promise_fill_pointer(shared_promises[i], NULL);
+        bnr_promise_release(shared_promises[i]);
+    }
+    return NULL;
+}
+
+static void benchmark_fill_from_native_thread(void) {
+    shared_promises = malloc(sizeof(bnr_promise_t) * (size_t)iteration_count);
+    for (long i = 0; i < iteration_count; i++) {
+        shared_promises[i] = bnr_promise_create();
+        bnr_promise_retain(shared_promises[i]);
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_t filler;
+    pthread_create(&filler, NULL, fill_all, NULL);
+    for (long i = 0; i < iteration_count; i++) {
+        bnr_promise_payload_t payload;
+        while (!bnr_promise_take(shared_promises[i], &payload)) {
+        }
+        bnr_promise_release(shared_promises[i]);
+    }
+    pthread_join(filler, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    report("fill racing with take, two threads", start, end);
+
+    free(shared_promises);
+}
+
+int main(void) {
+    benchmark_fill_pointer();
+    benchmark_fill_pointer_with_handler();
+    benchmark_fill_bytes_then_take();
+    benchmark_fill_from_native_thread();
+    return 0;
+}
@@ -0,0 +1,182 @@
+//
+//  DeferredBenchmarks.swift
+//  DeferredBenchmarks
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+import XCTest
+import Dispatch
+import Deferred
+
+/// Measures the hot paths of `Deferred` from outside its module, the way
+/// clients call them, so that cross-module specialization is included.
+///
+/// Run these in release: `swift test -c release --filter DeferredBenchmarks`.
+class DeferredBenchmarks: XCTestCase {
+
+    private let iterationCount = 100_000
+
+    private final class InlineExecutor: Executor {
+        func submit(_ body: @escaping() -> Void) {
+            body()
+        }
+    }
+
+    func testFillAndPeekInt() {
+        measure {
+            var sum = 0
+            for index in 0 ..< iterationCount {
+                let deferred = Deferred<Int>()
+                deferred.fill(with: index)
+                sum &+= deferred.peek() ?? 0
+            }
+            XCTAssertEqual(sum, (0 ..< iterationCount).reduce(0, &+))
+        }
+    }
+
+    func testUponFilledInline() {
+        let deferred = Deferred(filledWith: 1)
+        let executor = InlineExecutor()
+
+        measure {
+            var sum = 0
+            for _ in 0 ..< iterationCount {
+                deferred.upon(executor) { (value) in
+                    sum &+= value
+                }
+            }
+            XCTAssertEqual(sum, iterationCount)
+        }
+    }
+
+    func testUponFilledOnDispatchQueue() {
+        let deferred = Deferred<Int>()
+        deferred.fill(with: 1)
+        let queue = DispatchQueue(label: #function, qos: .userInitiated)
+        let group = DispatchGroup()
+
+        measure {
+            for _ in 0 ..< iterationCount {
+                group.enter()
+                deferred.upon(queue) { _ in
+                    group.leave()
+                }
+            }
+            group.wait()
+        }
+    }
+
+    func testFillWithOneUpon() {
+        let executor = InlineExecutor()
+
+        measure {
+            var sum = 0
+            for index in 0 ..< iterationCount {
+                let deferred = Deferred<Int>()
+                deferred.upon(executor) { (value) in
+                    sum &+= value
+                }
+                deferred.fill(with: index)
+            }
+            XCTAssertEqual(sum, (0 ..< iterationCount).reduce(0, &+))
+        }
+    }
+
+    func testFillWithOneUponOneShot() {
+        let executor = InlineExecutor()
+
+        measure {
+            var sum = 0
+            for index in 0 ..< iterationCount {
+                let oneShot = OneShot<Int>()
+                oneShot.upon(executor) { (value) in
+                    sum &+= value
+                }
+                oneShot.fill(with: index)
+            }
+            XCTAssertEqual(sum, (0 ..< iterationCount).reduce(0, &+))
+        }
+    }
+
+    // The consumer mutates the buffer it is handed. A deferred keeps its own
+    // reference to the value, so each mutation copies the buffer.
+    func testHandOffLargeBufferThroughDeferred() {
+        let queue = DispatchQueue(label: #function, qos: .userInitiated)
+        let group = DispatchGroup()
+
+        measure {
+            for _ in 0 ..< 100 {
+                let deferred = Deferred<[UInt8]>()
+                group.enter()
+                deferred.upon(queue) { (value) in
+                    var value = value
+                    value[0] = 1
+                    group.leave()
+                }
+                deferred.fill(with: [UInt8](repeating: 0, count: 1 << 20))
+            }
+            group.wait()
+        }
+    }
+
+    func testHandOffLargeBufferThroughOneShot() {
+        let queue = DispatchQueue(label: #function, qos: .userInitiated)
+        let group = DispatchGroup()
+
+        measure {
+            for _ in 0 ..< 100 {
+                let oneShot = OneShot<[UInt8]>()
+                group.enter()
+                oneShot.upon(queue, consuming: { (value) in
+                    value[0] = 1
+                    group.leave()
+                })
+                oneShot.fill(with: [UInt8](repeating: 0, count: 1 << 20))
+            }
+            group.wait()
+        }
+    }
+
+    // Half of the threads subscribe while the other half poll for a value,
+    // so both contend on one deferred before and after it is filled.
+    private func measureManyReadersAndSubscribers(makeDeferred: () -> Deferred<Int>) {
+        let executor = InlineExecutor()
+        let threadCount = 2 * ProcessInfo.processInfo.activeProcessorCount
+        let operationCount = iterationCount / threadCount
+
+        measure {
+            let deferred = makeDeferred()
+            let group = DispatchGroup()
+            DispatchQueue.concurrentPerform(iterations: threadCount) { (thread) in
+                if thread == threadCount / 2 {
+                    deferred.fill(with: 1)
+                }
+
+                if thread.isMultiple(of: 2) {
+                    for _ in 0 ..< operationCount {
+                        group.enter()
+                        deferred.upon(executor) { _ in
+                            group.leave()
+                        }
+                    }
+                } else {
+                    for _ in 0 ..< operationCount {
+                        _ = deferred.peek()
+                    }
+                }
+            }
+            group.wait()
+        }
+    }
+
+    func testManyReadersAndSubscribers() {
+        measureManyReadersAndSubscribers(makeDeferred: { Deferred<Int>() })
+    }
+
+    func testManyReadersAndSubscribersWithExpectedSubscribers() {
+        let expectedSubscribers = iterationCount / 2
+        measureManyReadersAndSubscribers(makeDeferred: { Deferred<Int>(expectedSubscribers: expectedSubscribers) })
+    }
+}
@@ -0,0 +1,89 @@
+//
+//  ContinuationPoolTests.swift
+//  DeferredTests
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+import XCTest
+import Dispatch
+import Deferred
+
+class ContinuationPoolTests: XCTestCase {
+    static let allTests: [(String, (ContinuationPoolTests) -> () throws -> Void)] = [
+        ("testNodesAreReusedOnTheSameThread", testNodesAreReusedOnTheSameThread),
+        ("testNodesAreNotCountedWhenDisabled", testNodesAreNotCountedWhenDisabled),
+        ("testConcurrentUponAndFill", testConcurrentUponAndFill)
+    ]
+
+    override func setUp() {
+        super.setUp()
+
+        ContinuationPool.isEnabled = true
+    }
+
+    override func tearDown() {
+        ContinuationPool.isEnabled = false
+
+        super.tearDown()
+    }
+
+    func testNodesAreReusedOnTheSameThread() {
+        let executor = InlineExecutor()
+        let before = ContinuationPool.statistics
+
+        for _ in 0 ..< 100 {
+            let deferred = Deferred<Int>()
+            var sum = 0
+            for _ in 0 ..< 3 {
+                deferred.upon(executor) { sum += $0 }
+            }
+
+            deferred.fill(with: 1)
+            XCTAssertEqual(sum, 3)
+        }
+
+        let after = ContinuationPool.statistics
+        XCTAssertGreaterThanOrEqual(after.hits - before.hits, 2 * 99)
+    }
+
+    func testNodesAreNotCountedWhenDisabled() {
+        ContinuationPool.isEnabled = false
+        let executor = InlineExecutor()
+        let before = ContinuationPool.statistics
+
+        let deferred = Deferred<Int>()
+        var sum = 0
+        for _ in 0 ..< 3 {
+            deferred.upon(executor) { sum += $0 }
+        }
+        deferred.fill(with: 1)
+
+        let after = ContinuationPool.statistics
+        XCTAssertEqual(sum, 3)
+        XCTAssertEqual(after.hits, before.hits)
+        XCTAssertEqual(after.misses, before.misses)
+    }
+
+    func testConcurrentUponAndFill() {
+        let group = DispatchGroup()
+
+        DispatchQueue.concurrentPerform(iterations: 1_000) { (iteration) in
+            let deferred = Deferred<Int>()
+            for _ in 0 ..< 4 {
+                group.enter()
+                deferred.upon(.global()) { (value) in
+                    XCTAssertEqual(value, iteration)
+                    group.leave()
+                }
+            }
+
+            DispatchQueue.global().async {
+                deferred.fill(with: iteration)
+            }
+        }
+
+        XCTAssertEqual(group.wait(timeout: .now() + longTimeout), .success)
+    }
+}
@@ -0,0 +1,96 @@
+//
+//  DeferredArenaTests.swift
+//  DeferredTests
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+import XCTest
+import Dispatch
+import Deferred
+
+class DeferredArenaTests: XCTestCase {
+    static let allTests: [(String, (DeferredArenaTests) -> () throws -> Void)] = [
+        ("testAllocationsAreCountedOnlyWhileInstalled", testAllocationsAreCountedOnlyWhileInstalled),
+        ("testNodesAreReusedWithinScope", testNodesAreReusedWithinScope),
+        ("testMapRunsTransformWithArenaInstalled", testMapRunsTransformWithArenaInstalled),
+        ("testEscapingDeferredOutlivesArena", testEscapingDeferredOutlivesArena)
+    ]
+
+    func testAllocationsAreCountedOnlyWhileInstalled() {
+        let arena = DeferredArena()
+        let deferreds = arena.withInstalled {
+            (0 ..< 10).map { _ in Deferred<Int>() }
+        }
+
+        let statistics = arena.statistics
+        XCTAssertEqual(statistics.allocationCount, 10)
+        XCTAssertGreaterThanOrEqual(statistics.bytesAllocated, 10 * MemoryLayout<Int>.size)
+
+        _ = Deferred<Int>()
+        XCTAssertEqual(arena.statistics.allocationCount, 10)
+        XCTAssertEqual(arena.statistics.bytesAllocated, statistics.bytesAllocated)
+        XCTAssertEqual(deferreds.count, 10)
+    }
+
+    func testNodesAreReusedWithinScope() {
+        let arena = DeferredArena()
+        let executor = InlineExecutor()
+
+        arena.withInstalled {
+            for _ in 0 ..< 100 {
+                let deferred = Deferred<Int>()
+                var sum = 0
+                for _ in 0 ..< 3 {
+                    deferred.upon(executor) { sum += $0 }
+                }
+
+                deferred.fill(with: 1)
+                XCTAssertEqual(sum, 3)
+            }
+        }
+
+        XCTAssertGreaterThanOrEqual(arena.statistics.reuseCount, 2 * 99)
+    }
+
+    func testMapRunsTransformWithArenaInstalled() {
+        let arena = DeferredArena()
+        let deferred = Deferred<Int>()
+        let mapped = arena.withInstalled {
+            deferred.map(upon: .any()) { (value) -> Deferred<Int> in
+                Deferred(filledWith: value)
+            }
+        }
+        let before = arena.statistics.allocationCount
+
+        deferred.fill(with: 1)
+
+        XCTAssertEqual(mapped.wait(until: .now() + shortTimeout)?.peek(), 1)
+        XCTAssertEqual(arena.statistics.allocationCount, before)
+
+        let nested = arena.withInstalled {
+            deferred.map(upon: .any()) { (_) in Deferred<Int>() }
+        }
+        XCTAssertNotNil(nested.wait(until: .now() + shortTimeout))
+        XCTAssertEqual(arena.statistics.allocationCount, before + 2)
+    }
+
+    func testEscapingDeferredOutlivesArena() {
+        var arena: DeferredArena? = DeferredArena()
+        let executor = InlineExecutor()
+        var calls = 0
+        let deferred = arena!.withInstalled { () -> Deferred<Int> in
+            let deferred = Deferred<Int>()
+            deferred.upon(executor) { _ in calls += 1 }
+            deferred.upon(executor) { _ in calls += 1 }
+            return deferred
+        }
+        arena = nil
+
+        deferred.fill(with: 1)
+
+        XCTAssertEqual(calls, 2)
+        XCTAssertEqual(deferred.peek(), 1)
+    }
+}
@@ -0,0 +1,152 @@
+//
+//  DeferredBudgetTests.swift
+//  DeferredTests
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+import XCTest
+import Dispatch
+import Deferred
+
+class DeferredBudgetTests: XCTestCase {
+    static let allTests: [(String, (DeferredBudgetTests) -> () throws -> Void)] = [
+        ("testUponPastBudgetIsRejected", testUponPastBudgetIsRejected),
+        ("testUponPastBudgetRunsWithSentinel", testUponPastBudgetRunsWithSentinel),
+        ("testUponPastBudgetIsDivertedToFallbackExecutor", testUponPastBudgetIsDivertedToFallbackExecutor),
+        ("testUponContentsOfAdmitsHandlersThatFit", testUponContentsOfAdmitsHandlersThatFit),
+        ("testUponAfterFillIgnoresBudget", testUponAfterFillIgnoresBudget),
+        ("testWaitPastBudgetWaitsForValue", testWaitPastBudgetWaitsForValue),
+        ("testHighWaterMark", testHighWaterMark)
+    ]
+
+    func testUponPastBudgetIsRejected() {
+        let deferred = Deferred<Int>(budget: .init(limit: 2))
+        let executor = InlineExecutor()
+        var calls = [Int]()
+
+        XCTAssert(deferred.tryUpon(executor) { calls.append($0) })
+        XCTAssert(deferred.tryUpon(executor) { calls.append($0 + 1) })
+        XCTAssertFalse(deferred.tryUpon(executor) { calls.append($0 + 2) })
+        XCTAssertEqual(calls, [])
+
+        deferred.fill(with: 10)
+
+        XCTAssertEqual(calls, [ 10, 11 ])
+    }
+
+    func testUponPastBudgetRunsWithSentinel() {
+        let deferred = Deferred<Int>(budget: .init(limit: 1, overflow: .substitute(-1)))
+        let executor = InlineExecutor()
+        var calls = [Int]()
+
+        XCTAssert(deferred.tryUpon(executor) { calls.append($0) })
+        XCTAssertFalse(deferred.tryUpon(executor) { calls.append($0) })
+        XCTAssertEqual(calls, [ -1 ])
+
+        deferred.fill(with: 10)
+
+        XCTAssertEqual(calls, [ -1, 10 ])
+    }
+
+    func testUponPastBudgetIsDivertedToFallbackExecutor() {
+        let fallback = CountingExecutor()
+        let deferred = Deferred<Int>(budget: .init(limit: 1, overflow: .divert(to: fallback, substituting: -1)))
+        let executor = InlineExecutor()
+        var calls = [Int]()
+
+        deferred.upon(executor) { calls.append($0) }
+        deferred.upon(executor) { calls.append($0) }
+        XCTAssertEqual(calls, [ -1 ])
+        XCTAssertEqual(fallback.submitCount, 1)
+
+        deferred.fill(with: 10)
+
+        XCTAssertEqual(calls, [ -1, 10 ])
+        XCTAssertEqual(fallback.submitCount, 1)
+    }
+
+    func testUponContentsOfAdmitsHandlersThatFit() {
+        let deferred = Deferred<Int>(budget: .init(limit: 3, overflow: .substitute(-1)))
+        let executor = InlineExecutor()
+        var calls = [Int]()
+
+        deferred.upon(executor) { calls.append($0) }
+        deferred.upon(contentsOf: (1 ... 4).map { (offset) -> (Executor, (Int) -> Void) in
+            (executor, { calls.append($0 < 0 ? $0 : $0 + offset) })
+        })
+        XCTAssertEqual(calls, [ -1, -1 ])
+
+        deferred.fill(with: 10)
+
+        XCTAssertEqual(calls, [ -1, -1, 10, 11, 12 ])
+    }
+
+    func testUponAfterFillIgnoresBudget() {
+        let deferred = Deferred<Int>(budget: .init(limit: 1))
+        let executor = InlineExecutor()
+        var calls = 0
+
+        XCTAssert(deferred.tryUpon(executor) { _ in calls += 1 })
+        XCTAssertFalse(deferred.tryUpon(executor) { _ in calls += 1 })
+        deferred.fill(with: 1)
+
+        for _ in 0 ..< 10 {
+            XCTAssert(deferred.tryUpon(executor) { _ in calls += 1 })
+        }
+        XCTAssertEqual(calls, 11)
+    }
+
+    func testWaitPastBudgetWaitsForValue() {
+        let budgets: [Deferred<Int>.Budget] = [
+            .init(limit: 1),
+            .init(limit: 1, overflow: .substitute(-1)),
+            .init(limit: 1, overflow: .divert(to: InlineExecutor(), substituting: -1))
+        ]
+
+        for budget in budgets {
+            let deferred = Deferred<Int>(budget: budget)
+            XCTAssert(deferred.tryUpon(InlineExecutor()) { _ in })
+
+            DispatchQueue.global().asyncAfter(deadline: .now() + 0.05) {
+                deferred.fill(with: 10)
+            }
+
+            XCTAssertEqual(deferred.wait(until: .now() + shortTimeout), 10)
+            XCTAssertEqual(deferred.pendingHighWaterMark, 1)
+        }
+    }
+
+    func testHighWaterMark() {
+        XCTAssertNil(Deferred<Int>().pendingHighWaterMark)
+
+        let deferred = Deferred<Int>(budget: .init(limit: 100))
+        XCTAssertEqual(deferred.pendingHighWaterMark, 0)
+
+        let executor = InlineExecutor()
+        let group = DispatchGroup()
+        DispatchQueue.concurrentPerform(iterations: 25) { _ in
+            group.enter()
+            deferred.upon(executor) { _ in
+                group.leave()
+            }
+        }
+        XCTAssertEqual(deferred.pendingHighWaterMark, 25)
+
+        deferred.fill(with: 1)
+        XCTAssertEqual(group.wait(timeout: .now() + shortTimeout), .success)
+
+        deferred.upon(executor) { _ in }
+        XCTAssertEqual(deferred.pendingHighWaterMark, 25)
+    }
+}
+
+private final class CountingExecutor: Executor {
+    var submitCount = 0
+
+    func submit(_ body: @escaping() -> Void) {
+        submitCount += 1
+        body()
+    }
+}
@@ -0,0 +1,99 @@
+//
+//  DeferredSlabTests.swift
+//  DeferredTests
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+import XCTest
+import Dispatch
+import Deferred
+
+class DeferredSlabTests: XCTestCase {
+    static let allTests: [(String, (DeferredSlabTests) -> () throws -> Void)] = [
+        ("testSlotsFillIndependently", testSlotsFillIndependently),
+        ("testCannotFillSlotMultipleTimes", testCannotFillSlotMultipleTimes),
+        ("testUponCalledWhenSlotFilled", testUponCalledWhenSlotFilled),
+        ("testFilledCountAndFirstUnfilledIndexAcrossWords", testFilledCountAndFirstUnfilledIndexAcrossWords),
+        ("testAllFilled", testAllFilled),
+        ("testValuesAreReleasedWithSlab", testValuesAreReleasedWithSlab)
+    ]
+
+    func testSlotsFillIndependently() {
+        let slab = DeferredSlab<String>(count: 3)
+        XCTAssert(slab[1].fill(with: "one"))
+
+        XCTAssertNil(slab[0].peek())
+        XCTAssertEqual(slab[1].peek(), "one")
+        XCTAssertNil(slab[2].peek())
+    }
+
+    func testCannotFillSlotMultipleTimes() {
+        let slab = DeferredSlab<Int>(count: 1)
+        XCTAssert(slab[0].fill(with: 1))
+        XCTAssertFalse(slab[0].fill(with: 2))
+        XCTAssertEqual(slab[0].value, 1)
+    }
+
+    func testUponCalledWhenSlotFilled() {
+        let slab = DeferredSlab<Int>(count: 2)
+        let expectations = slab.map { (slot) -> XCTestExpectation in
+            let expect = expectation(description: "upon called for slot \(slot.index)")
+            slot.upon(.any()) { (value) in
+                XCTAssertEqual(value, slot.index * 10)
+                expect.fulfill()
+            }
+            return expect
+        }
+
+        DispatchQueue.concurrentPerform(iterations: slab.count) { (index) in
+            slab[index].fill(with: index * 10)
+        }
+
+        wait(for: expectations, timeout: shortTimeout)
+    }
+
+    func testFilledCountAndFirstUnfilledIndexAcrossWords() {
+        let slab = DeferredSlab<Int>(count: 130)
+        XCTAssertEqual(slab.filledCount, 0)
+        XCTAssertEqual(slab.firstUnfilledIndex(), 0)
+
+        for index in 0 ..< 100 {
+            slab[index].fill(with: index)
+        }
+
+        XCTAssertEqual(slab.filledCount, 100)
+        XCTAssertEqual(slab.firstUnfilledIndex(), 100)
+        XCTAssertEqual(slab.firstUnfilledIndex(from: 120), 120)
+
+        for index in 100 ..< 130 {
+            slab[index].fill(with: index)
+        }
+
+        XCTAssertEqual(slab.filledCount, 130)
+        XCTAssertNil(slab.firstUnfilledIndex())
+    }
+
+    func testAllFilled() {
+        let slab = DeferredSlab<Int>(count: 100)
+        let combined = slab.allFilled()
+
+        DispatchQueue.concurrentPerform(iterations: slab.count) { (index) in
+            slab[index].fill(with: index)
+        }
+
+        XCTAssertEqual(combined.wait(until: .now() + shortTimeout), Array(0 ..< 100))
+    }
+
+    func testValuesAreReleasedWithSlab() {
+        let expect: XCTestExpectation
+        do {
+            let object = NSObject()
+            let slab = DeferredSlab<NSObject>(count: 2)
+            slab[1].fill(with: object)
+            expect = expectation(deallocationOf: object)
+        }
+        wait(for: [ expect ], timeout: shortTimeout)
+    }
+}
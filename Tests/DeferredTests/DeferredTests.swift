@@ -13,6 +13,22 @@ import Deferred
 // swiftlint:disable file_length
 // swiftlint:disable type_body_length
 
+private final class BatchRecordingExecutor: Executor {
+    var batchSizes = [Int]()
+
+    func submit(_ body: @escaping() -> Void) {
+        batchSizes.append(1)
+        body()
+    }
+
+    func submit(contentsOf bodies: [() -> Void]) {
+        batchSizes.append(bodies.count)
+        for body in bodies {
+            body()
+        }
+    }
+}
+
 class DeferredTests: XCTestCase {
     static let universalTests: [(String, (DeferredTests) -> () throws -> Void)] = [
         ("testPeekWhenUnfilled", testPeekWhenUnfilled),
@@ -21,19 +37,42 @@ class DeferredTests: XCTestCase {
         ("testValueOnFilled", testValueOnFilled),
         ("testValueBlocksWhileUnfilled", testValueBlocksWhileUnfilled),
         ("testValueUnblocksWhenUnfilledIsFilled", testValueUnblocksWhenUnfilledIsFilled),
+        ("testFillUnblocksEveryWaiter", testFillUnblocksEveryWaiter),
         ("testFill", testFill),
         ("testCannotFillMultipleTimes", testCannotFillMultipleTimes),
+        ("testBulkFill", testBulkFill),
+        ("testBulkFillSubmitsOnceToEachExecutor", testBulkFillSubmitsOnceToEachExecutor),
+        ("testBulkFillRunsHandlersOnConcurrentQueueInParallel", testBulkFillRunsHandlersOnConcurrentQueueInParallel),
         ("testIsFilled", testIsFilled),
+        ("testWithFilledValue", testWithFilledValue),
+        ("testWithFilledValueWhenValueIsObject", testWithFilledValueWhenValueIsObject),
+        ("testBorrowingUponCalledWhenFilled", testBorrowingUponCalledWhenFilled),
+        ("testBorrowingUponDoesNotCopyValue", testBorrowingUponDoesNotCopyValue),
+        ("testBorrowingUponReleasesUnfilledDeferred", testBorrowingUponReleasesUnfilledDeferred),
         ("testUponCalledWhenFilled", testUponCalledWhenFilled),
         ("testUponCalledIfAlreadyFilled", testUponCalledIfAlreadyFilled),
         ("testUponNotCalledWhileUnfilled", testUponNotCalledWhileUnfilled),
         ("testUponMainQueueCalledWhenFilled", testUponMainQueueCalledWhenFilled),
+        ("testCancelledSubscriptionNotCalledWhenFilled", testCancelledSubscriptionNotCalledWhenFilled),
+        ("testCancellingSubscriptionReleasesCapturesWhileUnfilled", testCancellingSubscriptionReleasesCapturesWhileUnfilled),
+        ("testCancellingSubscriptionAfterFillHasNoEffect", testCancellingSubscriptionAfterFillHasNoEffect),
+        ("testWeaklyOwnedUponCalledWhileOwnerIsAlive", testWeaklyOwnedUponCalledWhileOwnerIsAlive),
+        ("testWeaklyOwnedUponSkippedAfterOwnerDeallocates", testWeaklyOwnedUponSkippedAfterOwnerDeallocates),
+        ("testUponWhenFilledKeepsRegistrationOrder", testUponWhenFilledKeepsRegistrationOrder),
+        ("testFillSubmitsConsecutiveUponToSameExecutorAsBatch", testFillSubmitsConsecutiveUponToSameExecutorAsBatch),
+        ("testFillRunsHandlersOnConcurrentQueueInParallel", testFillRunsHandlersOnConcurrentQueueInParallel),
         ("testConcurrentUpon", testConcurrentUpon),
+        ("testUponContentsOfKeepsRegistrationOrder", testUponContentsOfKeepsRegistrationOrder),
+        ("testUponContentsOfWhenFilledSubmitsConsecutiveToSameExecutorAsBatch", testUponContentsOfWhenFilledSubmitsConsecutiveToSameExecutorAsBatch),
+        ("testUponWithExpectedSubscribersKeepsOrderAcrossChunks", testUponWithExpectedSubscribersKeepsOrderAcrossChunks),
+        ("testConcurrentUponAndFillWithExpectedSubscribers", testConcurrentUponAndFillWithExpectedSubscribers),
+        ("testFillWithExpectedSubscribersReleasesHandlers", testFillWithExpectedSubscribersReleasesHandlers),
         ("testAllCopiesOfADeferredValueRepresentTheSameDeferredValue", testAllCopiesOfADeferredValueRepresentTheSameDeferredValue),
         ("testDeferredOptionalBehavesCorrectly", testDeferredOptionalBehavesCorrectly),
         ("testIsFilledCanBeCalledMultipleTimesNotFilled", testIsFilledCanBeCalledMultipleTimesNotFilled),
         ("testIsFilledCanBeCalledMultipleTimesWhenFilled", testIsFilledCanBeCalledMultipleTimesWhenFilled),
         ("testSimultaneousFill", testSimultaneousFill),
+        ("testSimultaneousFillHasExactlyOneWinner", testSimultaneousFillHasExactlyOneWinner),
         ("testDebugDescriptionUnfilled", testDebugDescriptionUnfilled),
         ("testDebugDescriptionFilled", testDebugDescriptionFilled),
         ("testDebugDescriptionFilledWhenValueIsVoid", testDebugDescriptionFilledWhenValueIsVoid),
@@ -119,6 +158,24 @@ class DeferredTests: XCTestCase {
         wait(for: [ expect ], timeout: shortTimeout)
     }
 
+    func testFillUnblocksEveryWaiter() {
+        let deferred = Deferred<Int>()
+        let expectations = (0 ..< 8).map { expectation(description: "waiter \($0) unblocked") }
+
+        for expect in expectations {
+            DispatchQueue.global().async {
+                XCTAssertEqual(deferred.value, 4)
+                expect.fulfill()
+            }
+        }
+
+        afterShortDelay {
+            deferred.fill(with: 4)
+        }
+
+        wait(for: expectations, timeout: shortTimeout)
+    }
+
     func testFill() {
         let toBeFilled = Deferred<Int>()
         toBeFilled.fill(with: 1)
@@ -136,6 +193,66 @@ class DeferredTests: XCTestCase {
         XCTAssertEqual(toBeFilledRepeatedly.value, 1)
     }
 
+    func testBulkFill() {
+        let deferreds = (0 ..< 10).map { _ in Deferred<Int>() }
+        let objects = (0 ..< 10).map { _ in Deferred<NSObject>() }
+        deferreds[3].fill(with: -1)
+
+        let expect = expectation(description: "upon called for each deferred")
+        expect.expectedFulfillmentCount = deferreds.count
+        for deferred in deferreds {
+            deferred.upon(.any()) { _ in
+                expect.fulfill()
+            }
+        }
+
+        XCTAssertEqual(Deferred.fill(zip(deferreds, 0 ..< 10)), 9)
+        XCTAssertEqual(Deferred.fill(objects.map { ($0, NSObject()) }), 10)
+
+        wait(for: [ expect ], timeout: shortTimeout)
+        XCTAssertEqual(deferreds.map { $0.peek() }, [ 0, 1, 2, -1, 4, 5, 6, 7, 8, 9 ])
+        XCTAssert(objects.allSatisfy { $0.isFilled })
+    }
+
+    func testBulkFillSubmitsOnceToEachExecutor() {
+        let first = BatchRecordingExecutor()
+        let second = BatchRecordingExecutor()
+        let deferreds = (0 ..< 3).map { _ in Deferred<Int>() }
+        var calls = [Int]()
+
+        for deferred in deferreds {
+            deferred.upon(first) { calls.append($0) }
+            deferred.upon(second) { calls.append($0 + 10) }
+        }
+
+        Deferred.fill(zip(deferreds, 0 ..< 3))
+
+        XCTAssertEqual(first.batchSizes, [ 3 ])
+        XCTAssertEqual(second.batchSizes, [ 3 ])
+        XCTAssertEqual(calls, [ 0, 1, 2, 10, 11, 12 ])
+    }
+
+    // Each handler waits for all of the others to start, so they must overlap.
+    func testBulkFillRunsHandlersOnConcurrentQueueInParallel() {
+        let deferreds = (0 ..< 3).map { _ in Deferred<Int>() }
+        let queue = DispatchQueue(label: #function, attributes: .concurrent)
+        let started = DispatchGroup()
+        let expect = expectation(description: "every handler overlaps")
+        expect.expectedFulfillmentCount = deferreds.count
+
+        for deferred in deferreds {
+            started.enter()
+            deferred.upon(queue) { _ in
+                started.leave()
+                XCTAssertEqual(started.wait(timeout: .now() + self.shortTimeout), .success)
+                expect.fulfill()
+            }
+        }
+
+        XCTAssertEqual(Deferred.fill(deferreds.map { ($0, 1) }), deferreds.count)
+        wait(for: [ expect ], timeout: longTimeout)
+    }
+
     func testIsFilled() {
         let toBeFilled = Deferred<Int>()
         XCTAssertFalse(toBeFilled.isFilled)
@@ -149,6 +266,83 @@ class DeferredTests: XCTestCase {
         wait(for: [ expect ], timeout: shortTimeout)
     }
 
+    func testWithFilledValue() {
+        let deferred = Deferred<[Int]>()
+        XCTAssertNil(deferred.withFilledValue { $0.pointee.count })
+
+        deferred.fill(with: [ 1, 2, 3 ])
+        XCTAssertEqual(deferred.withFilledValue { $0.pointee.count }, 3)
+        XCTAssertEqual(Deferred(filledWith: [ 4, 5 ]).withFilledValue { $0.pointee.count }, 2)
+    }
+
+    func testWithFilledValueWhenValueIsObject() {
+        let deferred = Deferred<NSObject>()
+        XCTAssertFalse(deferred.isFilled)
+        XCTAssertNil(deferred.withFilledValue { $0.pointee })
+
+        let object = NSObject()
+        deferred.fill(with: object)
+        XCTAssert(deferred.isFilled)
+        XCTAssert(deferred.withFilledValue { $0.pointee } === object)
+    }
+
+    func testBorrowingUponCalledWhenFilled() {
+        let deferred = Deferred<[Int]>()
+        let expect = expectation(description: "borrowing upon blocks called")
+        expect.expectedFulfillmentCount = 10
+        for _ in 0 ..< 10 {
+            deferred.upon(.any(), borrowing: { (value) in
+                XCTAssertEqual(value.pointee, [ 1, 2, 3 ])
+                expect.fulfill()
+            })
+        }
+
+        deferred.fill(with: [ 1, 2, 3 ])
+        wait(for: [ expect ], timeout: shortTimeout)
+    }
+
+    func testBorrowingUponDoesNotCopyValue() {
+        final class Object {}
+        struct Payload {
+            var object: Object
+        }
+
+        // While suspended, the queue holds the handlers until `fill(with:)`
+        // has returned and let go of its argument. Then only the deferred
+        // holds `object`, unless a handler was given a copy of the value.
+        let queue = DispatchQueue(label: "BorrowingUpon")
+        queue.suspend()
+
+        let deferred = Deferred<Payload>()
+        let expect = expectation(description: "borrowing upon blocks called")
+        expect.expectedFulfillmentCount = 2
+        let body = { (value: UnsafePointer<Payload>) in
+            XCTAssert(isKnownUniquelyReferenced(&UnsafeMutablePointer(mutating: value).pointee.object))
+            expect.fulfill()
+        }
+
+        deferred.upon(queue, borrowing: body)
+        deferred.fill(with: Payload(object: Object()))
+        deferred.upon(queue, borrowing: body)
+
+        queue.resume()
+        wait(for: [ expect ], timeout: shortTimeout)
+    }
+
+    func testBorrowingUponReleasesUnfilledDeferred() {
+        let expect: XCTestExpectation
+        do {
+            let object = NSObject()
+            let deferred = Deferred<[NSObject]>()
+            deferred.upon(.any(), borrowing: { _ in
+                XCTFail("Unexpected borrowing upon call with capture \(object)")
+            })
+            expect = expectation(deallocationOf: object)
+        }
+
+        wait(for: [ expect ], timeout: shortTimeout)
+    }
+
     func testUponCalledWhenFilled() {
         let toBeFilled = Deferred<Int>()
         let allExpectations = (0 ..< 10).map { (iteration) -> XCTestExpectation in
@@ -194,6 +388,91 @@ class DeferredTests: XCTestCase {
         wait(for: [ expect ], timeout: shortTimeout)
     }
 
+    func testCancelledSubscriptionNotCalledWhenFilled() {
+        let deferred = Deferred<Int>()
+        let subscription = deferred.subscribe(upon: .any()) { (value) in
+            XCTFail("Unexpected subscription call with \(value)")
+        }
+
+        let expect = expectation(description: "later upon called")
+        deferred.upon(.any()) { _ in
+            expect.fulfill()
+        }
+
+        XCTAssert(subscription.cancel())
+        XCTAssert(subscription.isCancelled)
+        deferred.fill(with: 1)
+
+        wait(for: [ expect ], timeout: shortTimeout)
+    }
+
+    func testCancellingSubscriptionReleasesCapturesWhileUnfilled() {
+        let deferred = Deferred<Int>()
+        let expect: XCTestExpectation
+        do {
+            let object = NSObject()
+            let subscription = deferred.subscribe(upon: .any()) { (value) in
+                XCTFail("Unexpected subscription call with \(value) with capture \(object)")
+            }
+            expect = expectation(deallocationOf: object)
+            subscription.cancel()
+        }
+
+        wait(for: [ expect ], timeout: shortTimeout)
+        XCTAssertNil(deferred.peek())
+    }
+
+    func testCancellingSubscriptionAfterFillHasNoEffect() {
+        let deferred = Deferred<Int>()
+        let expect = expectation(description: "subscription called")
+        let subscription = deferred.subscribe(upon: .any()) { (value) in
+            XCTAssertEqual(value, 1)
+            expect.fulfill()
+        }
+
+        deferred.fill(with: 1)
+        wait(for: [ expect ], timeout: shortTimeout)
+
+        XCTAssertFalse(subscription.cancel())
+        XCTAssertFalse(subscription.isCancelled)
+    }
+
+    func testWeaklyOwnedUponCalledWhileOwnerIsAlive() {
+        let deferred = Deferred<Int>()
+        let owner = NSObject()
+
+        let expect = expectation(description: "upon called with owner")
+        deferred.upon(.any(), weaklyOwnedBy: owner) { (receivedOwner, value) in
+            XCTAssert(receivedOwner === owner)
+            XCTAssertEqual(value, 1)
+            expect.fulfill()
+        }
+
+        deferred.fill(with: 1)
+        wait(for: [ expect ], timeout: shortTimeout)
+    }
+
+    func testWeaklyOwnedUponSkippedAfterOwnerDeallocates() {
+        let deferred = Deferred<Int>()
+        let expect: XCTestExpectation
+        do {
+            let owner = NSObject()
+            deferred.upon(.any(), weaklyOwnedBy: owner) { (_, value) in
+                XCTFail("Unexpected upon handler call with \(value)")
+            }
+            expect = expectation(deallocationOf: owner)
+        }
+        wait(for: [ expect ], timeout: shortTimeout)
+
+        let laterExpect = expectation(description: "later upon called")
+        deferred.upon(.any()) { _ in
+            laterExpect.fulfill()
+        }
+
+        deferred.fill(with: 1)
+        wait(for: [ laterExpect ], timeout: shortTimeout)
+    }
+
     func testUponMainQueueCalledWhenFilled() {
         let deferred = Deferred<Int>()
 
@@ -208,6 +487,110 @@ class DeferredTests: XCTestCase {
         wait(for: [ expect ], timeout: shortTimeout)
     }
 
+    func testUponWhenFilledKeepsRegistrationOrder() {
+        let deferred = Deferred<Int>()
+        let queue = DispatchQueue(label: #function)
+        var order = [Int]()
+
+        let expect = expectation(description: "upon blocks called in order")
+        expect.expectedFulfillmentCount = 3
+
+        deferred.upon(queue) { _ in
+            order.append(0)
+            expect.fulfill()
+        }
+
+        deferred.fill(with: 1)
+
+        for index in 1 ..< 3 {
+            deferred.upon(queue) { _ in
+                order.append(index)
+                expect.fulfill()
+            }
+        }
+
+        wait(for: [ expect ], timeout: shortTimeout)
+        XCTAssertEqual(order, [ 0, 1, 2 ])
+    }
+
+    func testFillSubmitsConsecutiveUponToSameExecutorAsBatch() {
+        let first = BatchRecordingExecutor()
+        let second = BatchRecordingExecutor()
+        let deferred = Deferred<Int>()
+        var order = [Int]()
+
+        for (index, executor) in [ first, first, first, second, second, first ].enumerated() {
+            deferred.upon(executor) { _ in
+                order.append(index)
+            }
+        }
+
+        deferred.fill(with: 1)
+
+        XCTAssertEqual(order, [ 0, 1, 2, 3, 4, 5 ])
+        XCTAssertEqual(first.batchSizes, [ 3, 1 ])
+        XCTAssertEqual(second.batchSizes, [ 2 ])
+    }
+
+    func testUponContentsOfKeepsRegistrationOrder() {
+        for deferred in [ Deferred<Int>(), Deferred<Int>(expectedSubscribers: 4) ] {
+            let executor = InlineExecutor()
+            var order = [Int]()
+
+            deferred.upon(executor) { _ in
+                order.append(0)
+            }
+
+            deferred.upon(contentsOf: (1 ..< 10).map { (index) -> (Executor, (Int) -> Void) in
+                (executor, { _ in order.append(index) })
+            })
+
+            deferred.upon(executor) { _ in
+                order.append(10)
+            }
+
+            deferred.fill(with: 1)
+            XCTAssertEqual(order, Array(0 ... 10))
+        }
+    }
+
+    func testUponContentsOfWhenFilledSubmitsConsecutiveToSameExecutorAsBatch() {
+        let first = BatchRecordingExecutor()
+        let second = BatchRecordingExecutor()
+        let deferred = Deferred(filledWith: 1)
+        var order = [Int]()
+
+        deferred.upon(contentsOf: [ first, first, second, second, second ].enumerated().map { (index, executor) -> (Executor, (Int) -> Void) in
+            (executor, { _ in order.append(index) })
+        })
+
+        XCTAssertEqual(order, [ 0, 1, 2, 3, 4 ])
+        XCTAssertEqual(first.batchSizes, [ 2 ])
+        XCTAssertEqual(second.batchSizes, [ 3 ])
+    }
+
+    // Each handler waits for the other to start. Submitting both together as
+    // one work item would run them one after another, and time out.
+    func testFillRunsHandlersOnConcurrentQueueInParallel() {
+        let deferred = Deferred<Int>()
+        let queue = DispatchQueue(label: #function, attributes: .concurrent)
+        let started = DispatchGroup()
+        let expect = expectation(description: "both handlers overlap")
+        expect.expectedFulfillmentCount = 2
+
+        for _ in 0 ..< 2 {
+            started.enter()
+            deferred.upon(queue) { _ in
+                started.leave()
+                XCTAssertEqual(started.wait(timeout: .now() + self.shortTimeout), .success)
+                expect.fulfill()
+            }
+        }
+
+        deferred.fill(with: 1)
+        wait(for: [ expect ], timeout: longTimeout)
+    }
+
     func testConcurrentUpon() {
         let deferred = Deferred<Int>()
         let queue = DispatchQueue.global()
@@ -232,6 +615,69 @@ class DeferredTests: XCTestCase {
         wait(for: allExpectations, timeout: longTimeout)
     }
 
+    func testUponWithExpectedSubscribersKeepsOrderAcrossChunks() {
+        let deferred = Deferred<Int>(expectedSubscribers: 10)
+        let executor = InlineExecutor()
+        var order = [Int]()
+
+        for index in 0 ..< 100 {
+            deferred.upon(executor) { _ in
+                order.append(index)
+            }
+        }
+
+        deferred.fill(with: 1)
+
+        deferred.upon(executor) { _ in
+            order.append(100)
+        }
+
+        XCTAssertEqual(order, Array(0 ... 100))
+    }
+
+    func testConcurrentUponAndFillWithExpectedSubscribers() {
+        let deferred = Deferred<Int>(expectedSubscribers: 64)
+        let calls = Protected(initialValue: [Int](repeating: 0, count: 1_000))
+        let group = DispatchGroup()
+
+        group.enter()
+        DispatchQueue.global().async {
+            DispatchQueue.concurrentPerform(iterations: 1_000) { (iteration) in
+                group.enter()
+                deferred.upon(.global()) { _ in
+                    calls.withWriteLock { $0[iteration] += 1 }
+                    group.leave()
+                }
+
+                if iteration == 500 {
+                    deferred.fill(with: 1)
+                }
+            }
+            group.leave()
+        }
+
+        XCTAssertEqual(group.wait(timeout: .now() + longTimeout), .success)
+        XCTAssertEqual(calls.withReadLock { $0 }, [Int](repeating: 1, count: 1_000))
+    }
+
+    func testFillWithExpectedSubscribersReleasesHandlers() {
+        let deferred = Deferred<Int>(expectedSubscribers: 2)
+        let expect: XCTestExpectation
+        do {
+            let object = NSObject()
+            for _ in 0 ..< 5 {
+                deferred.upon(InlineExecutor()) { _ in
+                    _ = object
+                }
+            }
+            expect = expectation(deallocationOf: object)
+        }
+
+        deferred.fill(with: 1)
+
+        wait(for: [ expect ], timeout: shortTimeout)
+    }
+
     /// Deferred values behave as values: All copies reflect the same value.
     /// The wrinkle of course is that the value might not be observable till a later
     /// date.
@@ -358,6 +804,28 @@ class DeferredTests: XCTestCase {
         wait(for: [ expect ], timeout: shortTimeout)
     }
 
+    func testSimultaneousFillHasExactlyOneWinner() {
+        let deferreds = (0 ..< 100).map { _ in Deferred<Int>() }
+        let winners = Protected(initialValue: [Int?](repeating: nil, count: deferreds.count))
+
+        DispatchQueue.concurrentPerform(iterations: 8) { (filler) in
+            for (index, deferred) in deferreds.enumerated() {
+                guard deferred.fill(with: filler) else { continue }
+                winners.withWriteLock { (winners) in
+                    XCTAssertNil(winners[index])
+                    winners[index] = filler
+                }
+            }
+        }
+
+        winners.withReadLock { (winners) in
+            for (deferred, winner) in zip(deferreds, winners) {
+                XCTAssertNotNil(winner)
+                XCTAssertEqual(deferred.peek(), winner)
+            }
+        }
+    }
+
     func testDebugDescriptionUnfilled() {
         let unfilled = Deferred<Int>()
         XCTAssertEqual("\(unfilled)", "Deferred(not filled)")
@@ -0,0 +1,127 @@
+//
+//  DrainOffloadTests.swift
+//  DeferredTests
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+import XCTest
+import Dispatch
+import Deferred
+
+class DrainOffloadTests: XCTestCase {
+    static let allTests: [(String, (DrainOffloadTests) -> () throws -> Void)] = [
+        ("testFillReturnsBeforeOffloadedHandlersRun", testFillReturnsBeforeOffloadedHandlersRun),
+        ("testFillBelowThresholdRunsHandlersOnFillingThread", testFillBelowThresholdRunsHandlersOnFillingThread),
+        ("testOffloadedHandlersKeepOrderWithinChunk", testOffloadedHandlersKeepOrderWithinChunk),
+        ("testUponAfterOffloadedFillRunsBeforeWaitingHandlers", testUponAfterOffloadedFillRunsBeforeWaitingHandlers)
+    ]
+
+    override func setUp() {
+        super.setUp()
+
+        DrainOffload.threshold = 100
+    }
+
+    override func tearDown() {
+        DrainOffload.threshold = nil
+        DrainOffload.chunkSize = 4096
+
+        super.tearDown()
+    }
+
+    // Every handler blocks until the filling thread has returned. If the
+    // handlers were submitted on the filling thread, `fill` would never return.
+    func testFillReturnsBeforeOffloadedHandlersRun() {
+        let handlerCount = 200_000
+        DrainOffload.chunkSize = 10_000
+
+        let deferred = Deferred<Int>()
+        let executor = InlineExecutor()
+        let gate = DispatchSemaphore(value: 0)
+        let group = DispatchGroup()
+        for _ in 0 ..< handlerCount {
+            group.enter()
+            deferred.upon(executor) { _ in
+                gate.wait()
+                gate.signal()
+                group.leave()
+            }
+        }
+
+        let start = DispatchTime.now()
+        deferred.fill(with: 1)
+        let elapsed = DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds
+        gate.signal()
+
+        XCTAssertLessThan(elapsed, 100_000_000, "fill took longer than 100ms")
+        XCTAssertEqual(group.wait(timeout: .now() + longTimeout), .success)
+    }
+
+    func testFillBelowThresholdRunsHandlersOnFillingThread() {
+        let deferred = Deferred<Int>()
+        let executor = InlineExecutor()
+        var handled = 0
+        for _ in 0 ..< 10 {
+            deferred.upon(executor) { _ in
+                handled += 1
+            }
+        }
+
+        deferred.fill(with: 1)
+
+        XCTAssertEqual(handled, 10)
+    }
+
+    func testOffloadedHandlersKeepOrderWithinChunk() {
+        DrainOffload.threshold = 10
+        DrainOffload.chunkSize = 1_000
+
+        let deferred = Deferred<Int>()
+        let executor = InlineExecutor()
+        let calls = Protected(initialValue: [Int]())
+        let expect = expectation(description: "all handlers called")
+        expect.expectedFulfillmentCount = 500
+        for index in 0 ..< 500 {
+            deferred.upon(executor) { _ in
+                calls.withWriteLock { $0.append(index) }
+                expect.fulfill()
+            }
+        }
+
+        deferred.fill(with: 1)
+
+        wait(for: [ expect ], timeout: shortTimeout)
+        XCTAssertEqual(calls.withReadLock { $0 }, Array(0 ..< 500))
+    }
+
+    // The handlers added before the fill block until the one added after it
+    // has run. If it were queued behind them, none of them would ever run.
+    func testUponAfterOffloadedFillRunsBeforeWaitingHandlers() {
+        let deferred = Deferred<Int>()
+        let executor = InlineExecutor()
+        let gate = DispatchSemaphore(value: 0)
+        let calls = Protected(initialValue: [Int]())
+        let expect = expectation(description: "all handlers called")
+        expect.expectedFulfillmentCount = 201
+        for index in 0 ..< 200 {
+            deferred.upon(executor) { _ in
+                gate.wait()
+                gate.signal()
+                calls.withWriteLock { $0.append(index) }
+                expect.fulfill()
+            }
+        }
+
+        deferred.fill(with: 1)
+        deferred.upon(executor) { _ in
+            calls.withWriteLock { $0.append(-1) }
+            gate.signal()
+            expect.fulfill()
+        }
+
+        wait(for: [ expect ], timeout: shortTimeout)
+        XCTAssertEqual(calls.withReadLock { $0 }, [ -1 ] + Array(0 ..< 200))
+    }
+}
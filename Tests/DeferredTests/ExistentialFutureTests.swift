@@ -16,8 +16,15 @@ class ExistentialFutureTests: XCTestCase {
         ("testPeekWhenUnfilled", testPeekWhenUnfilled),
         ("testAnyWaitWithTimeout", testAnyWaitWithTimeout),
         ("testFilledAnyFutureUpon", testFilledAnyFutureUpon),
+        ("testFilledAnyFutureUponWeaklyOwned", testFilledAnyFutureUponWeaklyOwned),
+        ("testFilledAnyFutureOfLargeValue", testFilledAnyFutureOfLargeValue),
+        ("testFilledAnyFutureOfValueThatDoesNotFitInline", testFilledAnyFutureOfValueThatDoesNotFitInline),
+        ("testAnyFutureIsOneWord", testAnyFutureIsOneWord),
+        ("testNeverFutureIsNeverFilled", testNeverFutureIsNeverFilled),
         ("testUnfilledAnyUponCalledWhenFilled", testUnfilledAnyUponCalledWhenFilled),
         ("testFillAndIsFilledPostcondition", testFillAndIsFilledPostcondition),
+        ("testWrappedDeferredUponWeaklyOwned", testWrappedDeferredUponWeaklyOwned),
+        ("testWrappedDeferredWaitWithTimeout", testWrappedDeferredWaitWithTimeout),
         ("testDebugDescriptionUnfilled", testDebugDescriptionUnfilled),
         ("testDebugDescriptionFilled", testDebugDescriptionFilled),
         ("testDebugDescriptionFilledWhenValueIsVoid", testDebugDescriptionFilledWhenValueIsVoid),
@@ -74,6 +81,43 @@ class ExistentialFutureTests: XCTestCase {
         wait(for: allExpectations, timeout: longTimeout)
     }
 
+    func testFilledAnyFutureUponWeaklyOwned() {
+        let future = Future(value: true)
+        let owner = NSObject()
+        var result: Bool?
+        future.upon(InlineExecutor(), weaklyOwnedBy: owner) { (_, value) in
+            result = value
+        }
+        XCTAssertEqual(result, true)
+    }
+
+    func testFilledAnyFutureOfLargeValue() {
+        let future = Future(value: [ "a", "b", "c" ])
+        XCTAssertTrue(future.isFilled)
+        XCTAssertEqual(future.peek(), [ "a", "b", "c" ])
+        XCTAssertEqual(future.shortWait(), [ "a", "b", "c" ])
+    }
+
+    func testFilledAnyFutureOfValueThatDoesNotFitInline() {
+        XCTAssertEqual(Future<Int>(value: -1).peek(), -1)
+        XCTAssertEqual(Future<Int>(value: .min).shortWait(), .min)
+    }
+
+    func testAnyFutureIsOneWord() {
+        XCTAssertEqual(MemoryLayout<Future<Int>>.size, MemoryLayout<Int>.size)
+        XCTAssertEqual(MemoryLayout<Future<Void>>.size, MemoryLayout<Int>.size)
+        XCTAssertEqual(MemoryLayout<Future<[Int]>>.size, MemoryLayout<Int>.size)
+    }
+
+    func testNeverFutureIsNeverFilled() {
+        let future = Future<Void>.never
+        future.upon(InlineExecutor()) {
+            XCTFail("Never future should not call upon")
+        }
+        XCTAssertFalse(future.isFilled)
+        XCTAssertNil(future.shortWait())
+    }
+
     func testUnfilledAnyUponCalledWhenFilled() {
         let deferred = Deferred<Int>()
         anyFuture = deferred.eraseToFuture()
@@ -102,6 +146,33 @@ class ExistentialFutureTests: XCTestCase {
         XCTAssertTrue(anyFuture.isFilled)
     }
 
+    func testWrappedDeferredUponWeaklyOwned() {
+        let deferred = Deferred<Int>()
+        anyFuture = Future(deferred)
+
+        let owner = NSObject()
+        var results = [Int]()
+        anyFuture.upon(InlineExecutor(), weaklyOwnedBy: owner) { (_, value) in
+            results.append(value)
+        }
+        anyFuture.upon(InlineExecutor(), weaklyOwnedBy: NSObject()) { (_, value) in
+            results.append(-value)
+        }
+
+        deferred.fill(with: 1)
+        XCTAssertEqual(results, [ 1 ])
+        withExtendedLifetime(owner) {}
+    }
+
+    func testWrappedDeferredWaitWithTimeout() {
+        let deferred = Deferred<Int>()
+        let future = Future(deferred)
+        XCTAssertNil(future.shortWait())
+
+        deferred.fill(with: 42)
+        XCTAssertEqual(future.shortWait(), 42)
+    }
+
     func testDebugDescriptionUnfilled() {
         let future = Future<Int>.never
         XCTAssertEqual("\(future)", "Future(not filled)")
@@ -17,6 +17,8 @@ class FilledDeferredTests: XCTestCase {
         ("testValue", testValue),
         ("testCannotFillMultipleTimes", testCannotFillMultipleTimes),
         ("testIsFilled", testIsFilled),
+        ("testValueThatDoesNotFitInline", testValueThatDoesNotFitInline),
+        ("testIsOneWord", testIsOneWord),
         ("testUpon", testUpon),
         ("testUponMainQueueCalled", testUponMainQueueCalled),
         ("testConcurrentUpon", testConcurrentUpon),
@@ -55,6 +57,19 @@ class FilledDeferredTests: XCTestCase {
         XCTAssertTrue(filled.isFilled)
     }
 
+    func testValueThatDoesNotFitInline() {
+        XCTAssertEqual(Deferred<Int>(filledWith: -1).peek(), -1)
+        XCTAssertEqual(Deferred<Int>(filledWith: .max).peek(), .max)
+        XCTAssertEqual(Deferred<Double>(filledWith: 0.5).peek(), 0.5)
+    }
+
+    func testIsOneWord() {
+        XCTAssertEqual(MemoryLayout<Deferred<Int>>.size, MemoryLayout<Int>.size)
+        XCTAssertEqual(MemoryLayout<Deferred<Void>>.size, MemoryLayout<Int>.size)
+        XCTAssertEqual(MemoryLayout<Deferred<[Int]>>.size, MemoryLayout<Int>.size)
+        XCTAssertEqual(MemoryLayout<Deferred<AnyObject>>.size, MemoryLayout<Int>.size)
+    }
+
     func testUpon() {
         let filled = Deferred<Int>(filledWith: 1)
 
@@ -0,0 +1,87 @@
+//
+//  HandlerPriorityTests.swift
+//  DeferredTests
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+import XCTest
+import Dispatch
+import Deferred
+
+class HandlerPriorityTests: XCTestCase {
+    static let allTests: [(String, (HandlerPriorityTests) -> () throws -> Void)] = [
+        ("testUponWithoutPriorityKeepsOrder", testUponWithoutPriorityKeepsOrder),
+        ("testHigherPriorityHandlersRunFirst", testHigherPriorityHandlersRunFirst),
+        ("testHigherPriorityHandlersRunFirstWithExpectedSubscribers", testHigherPriorityHandlersRunFirstWithExpectedSubscribers),
+        ("testPrioritiesAddedFromManyThreadsIntoChunksRunFirst", testPrioritiesAddedFromManyThreadsIntoChunksRunFirst),
+        ("testUponWithPriorityWhenFilledRunsImmediately", testUponWithPriorityWhenFilledRunsImmediately)
+    ]
+
+    func testUponWithoutPriorityKeepsOrder() {
+        let deferred = Deferred<Int>()
+        let executor = InlineExecutor()
+        var order = [Int]()
+        for index in 0 ..< 5 {
+            deferred.upon(executor) { _ in order.append(index) }
+        }
+
+        deferred.fill(with: 1)
+
+        XCTAssertEqual(order, [ 0, 1, 2, 3, 4 ])
+    }
+
+    private func assertPriorityOrder(of deferred: Deferred<Int>, file: StaticString = #file, line: UInt = #line) {
+        let executor = InlineExecutor()
+        var order = [String]()
+        deferred.upon(executor, priority: .low) { _ in order.append("low") }
+        deferred.upon(executor) { _ in order.append("normal 1") }
+        deferred.upon(executor, priority: .high) { _ in order.append("high 1") }
+        deferred.upon(executor) { _ in order.append("normal 2") }
+        deferred.upon(executor, priority: .high) { _ in order.append("high 2") }
+        deferred.upon(executor, priority: HandlerPriority(rawValue: 100)) { _ in order.append("highest") }
+
+        deferred.fill(with: 1)
+
+        XCTAssertEqual(order, [ "highest", "high 1", "high 2", "normal 1", "normal 2", "low" ], file: file, line: line)
+    }
+
+    func testHigherPriorityHandlersRunFirst() {
+        assertPriorityOrder(of: Deferred())
+    }
+
+    func testHigherPriorityHandlersRunFirstWithExpectedSubscribers() {
+        assertPriorityOrder(of: Deferred(expectedSubscribers: 2))
+    }
+
+    // The first handler takes the inline slot, so every prioritized handler
+    // is stored in a chunk by some other thread than the one filling.
+    func testPrioritiesAddedFromManyThreadsIntoChunksRunFirst() {
+        let deferred = Deferred<Int>(expectedSubscribers: 16)
+        let executor = InlineExecutor()
+        var order = [HandlerPriority]()
+        deferred.upon(executor) { _ in order.append(.normal) }
+
+        DispatchQueue.concurrentPerform(iterations: 200) { (index) in
+            let priority: HandlerPriority = index % 4 == 0 ? .high : .normal
+            deferred.upon(executor, priority: priority) { _ in order.append(priority) }
+        }
+
+        deferred.fill(with: 1)
+
+        XCTAssertEqual(order.count, 201)
+        XCTAssertEqual(Array(order.prefix(50)), [HandlerPriority](repeating: .high, count: 50))
+        XCTAssertFalse(order.dropFirst(50).contains(.high))
+    }
+
+    func testUponWithPriorityWhenFilledRunsImmediately() {
+        let deferred = Deferred<Int>()
+        deferred.fill(with: 42)
+
+        var result: Int?
+        deferred.upon(InlineExecutor(), priority: .low) { result = $0 }
+
+        XCTAssertEqual(result, 42)
+    }
+}
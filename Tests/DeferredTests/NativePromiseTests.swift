@@ -0,0 +1,147 @@
+//
+//  NativePromiseTests.swift
+//  DeferredTests
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+import XCTest
+import Dispatch
+import Deferred
+import CAtomics
+
+class NativePromiseTests: XCTestCase {
+    static let allTests: [(String, (NativePromiseTests) -> () throws -> Void)] = [
+        ("testFillBytesFillsFuture", testFillBytesFillsFuture),
+        ("testFilledBytesAreNotCopied", testFilledBytesAreNotCopied),
+        ("testFillPointerBeforeCreatingFutureFillsFuture", testFillPointerBeforeCreatingFutureFillsFuture),
+        ("testCannotFillMultipleTimes", testCannotFillMultipleTimes),
+        ("testReadingDoesNotRegisterHandler", testReadingDoesNotRegisterHandler),
+        ("testUponCalledAfterFillFromNativeThread", testUponCalledAfterFillFromNativeThread),
+        ("testMapCalledAfterFillFromNativeThread", testMapCalledAfterFillFromNativeThread),
+        ("testWaitPicksUpFillFromNativeThread", testWaitPicksUpFillFromNativeThread),
+        ("testAbandonedPromiseReleasesHandlers", testAbandonedPromiseReleasesHandlers)
+    ]
+
+    func testFillBytesFillsFuture() {
+        let (future, handle) = NativeFuture.make()
+        let promise = UnsafeMutablePointer<bnr_promise_s>(handle)
+        XCTAssertNil(future.peek())
+
+        let bytes: [UInt8] = [ 1, 2, 3 ]
+        XCTAssert(bnr_promise_fill_bytes(promise, bytes, bytes.count))
+        bnr_promise_release(promise)
+
+        guard case .bytes(let filled)? = future.peek() else { return XCTFail("Expected bytes") }
+        XCTAssertEqual(Array(filled), bytes)
+    }
+
+    func testFilledBytesAreNotCopied() {
+        let (future, handle) = NativeFuture.make()
+        let promise = UnsafeMutablePointer<bnr_promise_s>(handle)
+
+        var byte: UInt8 = 42
+        XCTAssert(bnr_promise_fill_bytes(promise, &byte, 1))
+        let buffer = promise.pointee.payload.data
+        bnr_promise_release(promise)
+
+        guard case .bytes(let filled)? = future.peek() else { return XCTFail("Expected bytes") }
+        XCTAssertEqual(filled.withUnsafeBytes { $0.baseAddress }, buffer)
+    }
+
+    func testFillPointerBeforeCreatingFutureFillsFuture() {
+        guard let promise = bnr_promise_create() else { return XCTFail("Could not create promise") }
+        var target = 0
+        XCTAssert(bnr_promise_fill_pointer(promise, &target))
+
+        let future = NativeFuture(nativePromise: OpaquePointer(promise))
+        bnr_promise_release(promise)
+
+        guard case .pointer(let pointer)? = future.peek() else { return XCTFail("Expected pointer") }
+        XCTAssertEqual(pointer, UnsafeMutableRawPointer(&target))
+    }
+
+    func testCannotFillMultipleTimes() {
+        let (future, handle) = NativeFuture.make()
+        let promise = UnsafeMutablePointer<bnr_promise_s>(handle)
+
+        XCTAssert(bnr_promise_fill_pointer(promise, nil))
+        XCTAssertFalse(bnr_promise_fill_bytes(promise, nil, 0))
+        bnr_promise_release(promise)
+
+        guard case .pointer(nil)? = future.peek() else { return XCTFail("Expected first fill") }
+    }
+
+    func testReadingDoesNotRegisterHandler() {
+        let (future, handle) = NativeFuture.make()
+        let promise = UnsafeMutablePointer<bnr_promise_s>(handle)
+        XCTAssertNil(future.peek())
+        XCTAssertFalse(future.isFilled)
+
+        XCTAssert(bnr_promise_fill_pointer(promise, nil))
+        XCTAssertNil(promise.pointee.handler)
+        XCTAssertTrue(future.isFilled)
+        bnr_promise_release(promise)
+    }
+
+    func testUponCalledAfterFillFromNativeThread() {
+        let (future, handle) = NativeFuture.make()
+        let expect = expectation(description: "future filled")
+        future.upon(.any()) { (payload) in
+            guard case .bytes(let bytes) = payload else { return XCTFail("Expected bytes") }
+            XCTAssertEqual(Array(bytes), [ 42 ])
+            expect.fulfill()
+        }
+
+        let promise = UnsafeMutablePointer<bnr_promise_s>(handle)
+        DispatchQueue.global().async {
+            var byte: UInt8 = 42
+            _ = bnr_promise_fill_bytes(promise, &byte, 1)
+            bnr_promise_release(promise)
+        }
+
+        wait(for: [ expect ], timeout: shortTimeout)
+    }
+
+    func testMapCalledAfterFillFromNativeThread() {
+        let (future, handle) = NativeFuture.make()
+        let mapped = future.map(upon: .any()) { (payload) -> Bool in
+            guard case .pointer(nil) = payload else { return false }
+            return true
+        }
+
+        let promise = UnsafeMutablePointer<bnr_promise_s>(handle)
+        DispatchQueue.global().async {
+            _ = bnr_promise_fill_pointer(promise, nil)
+            bnr_promise_release(promise)
+        }
+
+        XCTAssertEqual(mapped.shortWait(), true)
+    }
+
+    func testWaitPicksUpFillFromNativeThread() {
+        let (future, handle) = NativeFuture.make()
+        let promise = UnsafeMutablePointer<bnr_promise_s>(handle)
+        DispatchQueue.global().async {
+            _ = bnr_promise_fill_pointer(promise, nil)
+            bnr_promise_release(promise)
+        }
+
+        guard case .pointer(nil)? = future.wait(until: .now() + shortTimeout) else { return XCTFail("Expected pointer") }
+    }
+
+    func testAbandonedPromiseReleasesHandlers() {
+        let expect: XCTestExpectation
+        do {
+            let object = NSObject()
+            let (future, handle) = NativeFuture.make()
+            future.upon(.any()) { _ in
+                XCTFail("Abandoned promise should never fill \(object)")
+            }
+            expect = expectation(deallocationOf: object)
+            bnr_promise_release(UnsafeMutablePointer(handle))
+        }
+        wait(for: [ expect ], timeout: shortTimeout)
+    }
+}
@@ -0,0 +1,120 @@
+//
+//  OneShotTests.swift
+//  DeferredTests
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+import XCTest
+import Dispatch
+import Deferred
+
+class OneShotTests: XCTestCase {
+    static let allTests: [(String, (OneShotTests) -> () throws -> Void)] = [
+        ("testUponCalledWhenFilled", testUponCalledWhenFilled),
+        ("testUponCalledIfAlreadyFilled", testUponCalledIfAlreadyFilled),
+        ("testCannotFillMultipleTimes", testCannotFillMultipleTimes),
+        ("testTakeReturnsNilUntilFilled", testTakeReturnsNilUntilFilled),
+        ("testConsumingUponOwnsValue", testConsumingUponOwnsValue),
+        ("testConcurrentFillAndUpon", testConcurrentFillAndUpon),
+        ("testConvertingToFuture", testConvertingToFuture),
+        ("testUnconsumedValueIsReleased", testUnconsumedValueIsReleased)
+    ]
+
+    func testUponCalledWhenFilled() {
+        let oneShot = OneShot<Int>()
+        let expect = expectation(description: "upon called when filled")
+        oneShot.upon(.any()) { (value) in
+            XCTAssertEqual(value, 1)
+            expect.fulfill()
+        }
+
+        XCTAssertFalse(oneShot.isFilled)
+        oneShot.fill(with: 1)
+        XCTAssert(oneShot.isFilled)
+
+        wait(for: [ expect ], timeout: shortTimeout)
+    }
+
+    func testUponCalledIfAlreadyFilled() {
+        let oneShot = OneShot<Int>()
+        oneShot.fill(with: 1)
+
+        var result: Int?
+        oneShot.upon(InlineExecutor()) { result = $0 }
+
+        XCTAssertEqual(result, 1)
+    }
+
+    func testCannotFillMultipleTimes() {
+        let oneShot = OneShot<Int>()
+        XCTAssert(oneShot.fill(with: 1))
+        XCTAssertFalse(oneShot.fill(with: 2))
+        XCTAssertEqual(oneShot.take(), 1)
+    }
+
+    func testTakeReturnsNilUntilFilled() {
+        let oneShot = OneShot<String>()
+        XCTAssertNil(oneShot.take())
+        XCTAssertNil(oneShot.take())
+
+        oneShot.fill(with: "hello")
+
+        XCTAssertEqual(oneShot.take(), "hello")
+        XCTAssert(oneShot.isFilled)
+    }
+
+    func testConsumingUponOwnsValue() {
+        let oneShot = OneShot<NSObject>()
+        oneShot.fill(with: NSObject())
+
+        var isUnique = false
+        oneShot.upon(InlineExecutor(), consuming: { (value) in
+            isUnique = isKnownUniquelyReferenced(&value)
+        })
+
+        XCTAssert(isUnique)
+    }
+
+    func testConcurrentFillAndUpon() {
+        let iterations = 1_000
+        let expect = expectation(description: "every one-shot consumed")
+        expect.expectedFulfillmentCount = iterations
+
+        DispatchQueue.concurrentPerform(iterations: iterations) { (iteration) in
+            let oneShot = OneShot<Int>()
+            DispatchQueue.global().async {
+                oneShot.fill(with: iteration)
+            }
+            oneShot.upon(.global()) { (value) in
+                XCTAssertEqual(value, iteration)
+                expect.fulfill()
+            }
+        }
+
+        wait(for: [ expect ], timeout: longTimeout)
+    }
+
+    func testConvertingToFuture() {
+        let oneShot = OneShot<Int>()
+        let future = Future(oneShot)
+        XCTAssertNil(future.peek())
+
+        oneShot.fill(with: 42)
+
+        XCTAssertEqual(future.peek(), 42)
+        XCTAssertEqual(future.wait(until: .now() + shortTimeout), 42)
+    }
+
+    func testUnconsumedValueIsReleased() {
+        let expect: XCTestExpectation
+        do {
+            let object = NSObject()
+            let oneShot = OneShot<NSObject>()
+            oneShot.fill(with: object)
+            expect = expectation(deallocationOf: object)
+        }
+        wait(for: [ expect ], timeout: shortTimeout)
+    }
+}
@@ -0,0 +1,99 @@
+//
+//  PromisePoolTests.swift
+//  DeferredTests
+//
+//  Created by Big Nerd Ranch on 10/16/26.
+//  Copyright © 2026 Big Nerd Ranch. Licensed under MIT.
+//
+
+import XCTest
+import Dispatch
+import Deferred
+
+class PromisePoolTests: XCTestCase {
+    static let allTests: [(String, (PromisePoolTests) -> () throws -> Void)] = [
+        ("testUponCalledWhenFilled", testUponCalledWhenFilled),
+        ("testRecycledPromiseStartsUnfilled", testRecycledPromiseStartsUnfilled),
+        ("testStalePromiseDoesNotObserveRecycledValue", testStalePromiseDoesNotObserveRecycledValue),
+        ("testCannotRecycleStalePromise", testCannotRecycleStalePromise),
+        ("testRecyclingUnfilledPromiseReleasesHandlers", testRecyclingUnfilledPromiseReleasesHandlers)
+    ]
+
+    func testUponCalledWhenFilled() {
+        let pool = PromisePool<Int>()
+        let promise = pool.makePromise()
+        let expect = expectation(description: "upon called when filled")
+        expect.expectedFulfillmentCount = 3
+        for _ in 0 ..< 3 {
+            promise.upon(.any()) { (value) in
+                XCTAssertEqual(value, 1)
+                expect.fulfill()
+            }
+        }
+
+        XCTAssert(promise.fill(with: 1))
+        XCTAssertFalse(promise.fill(with: 2))
+        wait(for: [ expect ], timeout: shortTimeout)
+        XCTAssertEqual(promise.wait(until: .now() + shortTimeout), 1)
+    }
+
+    func testRecycledPromiseStartsUnfilled() {
+        let pool = PromisePool<Int>()
+        let first = pool.makePromise()
+        first.fill(with: 1)
+        XCTAssert(pool.recycle(first))
+
+        let second = pool.makePromise()
+        XCTAssertFalse(second.isStale)
+        XCTAssertFalse(second.isFilled)
+        XCTAssertNil(second.peek())
+        XCTAssert(second.fill(with: 2))
+        XCTAssertEqual(second.peek(), 2)
+    }
+
+    func testStalePromiseDoesNotObserveRecycledValue() {
+        let pool = PromisePool<Int>(limit: 1)
+        let stale = pool.makePromise()
+        stale.fill(with: 1)
+        pool.recycle(stale)
+
+        let current = pool.makePromise()
+        current.fill(with: 2)
+
+        XCTAssert(stale.isStale)
+        XCTAssertFalse(stale.isFilled)
+        XCTAssertNil(stale.peek())
+        XCTAssertNil(stale.wait(until: .now() + shortTimeout))
+        XCTAssertFalse(stale.fill(with: 3))
+        stale.upon(InlineExecutor()) { _ in
+            XCTFail("A stale promise should never call its handlers")
+        }
+        XCTAssertEqual(current.peek(), 2)
+    }
+
+    func testCannotRecycleStalePromise() {
+        let pool = PromisePool<Int>()
+        let promise = pool.makePromise()
+        promise.fill(with: 1)
+
+        XCTAssert(pool.recycle(promise))
+        XCTAssertFalse(pool.recycle(promise))
+    }
+
+    func testRecyclingUnfilledPromiseReleasesHandlers() {
+        let pool = PromisePool<Int>()
+        let promise = pool.makePromise()
+        let expect: XCTestExpectation
+        do {
+            let object = NSObject()
+            promise.upon(InlineExecutor()) { _ in
+                XCTFail("Handlers should be released without being called")
+                _ = object
+            }
+            expect = expectation(deallocationOf: object)
+        }
+
+        XCTAssert(pool.recycle(promise))
+        wait(for: [ expect ], timeout: shortTimeout)
+    }
+}
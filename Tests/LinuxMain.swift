@@ -11,13 +11,23 @@ import XCTest
 @testable import TaskTests
 
 XCTMain([
+    testCase(ContinuationPoolTests.allTests),
+    testCase(DeferredArenaTests.allTests),
+    testCase(DeferredBudgetTests.allTests),
+    testCase(DeferredSlabTests.allTests),
     testCase(DeferredTests.allTests),
+    testCase(DrainOffloadTests.allTests),
     testCase(ExistentialFutureTests.allTests),
     testCase(FilledDeferredTests.allTests),
     testCase(FutureCustomExecutorTests.allTests),
     testCase(FutureIgnoreTests.allTests),
     testCase(FutureTests.allTests),
+    testCase(HandlerPriorityTests.allTests),
+    testCase(NativePromiseTests.allTests),
     testCase(ObjectDeferredTests.allTests),
+    testCase(OneShotTests.allTests),
+    testCase(PerformanceTests.allTests),
+    testCase(PromisePoolTests.allTests),
     testCase(ProtectedTests.allTests),
     testCase(ProtectedTestsUsingDispatchSemaphore.allTests),
     testCase(ProtectedTestsUsingPOSIXReadWriteLock.allTests),
@@ -30,7 +30,8 @@ class TaskTests: CustomExecutorTestCase {
         ("testThatFallbackUsingCustomExecutorReturnsOriginalSuccessValue", testThatFallbackUsingCustomExecutorReturnsOriginalSuccessValue),
         ("testThatFallbackForwardsCancellationToSubsequentTask", testThatFallbackForwardsCancellationToSubsequentTask),
         ("testThatFallbackSubstitutesThrownError", testThatFallbackSubstitutesThrownError),
-        ("testSimpleFutureCanBeUpgradedToTask", testSimpleFutureCanBeUpgradedToTask)
+        ("testSimpleFutureCanBeUpgradedToTask", testSimpleFutureCanBeUpgradedToTask),
+        ("testAllSucceededWithSlab", testAllSucceededWithSlab)
     ]
 
     private func expectation<T: Equatable>(that task: Task<T>, succeedsWith makeExpected: @autoclosure @escaping() -> T, description: String? = nil) -> XCTestExpectation {
@@ -320,4 +321,19 @@ class TaskTests: CustomExecutorTestCase {
             repeatCalledExpectation
         ], timeout: shortTimeout)
     }
+
+    func testAllSucceededWithSlab() {
+        let slab = DeferredSlab<Task<Int>.Result>(count: 3)
+        let expect = expectation(description: "allSucceeded is called")
+        slab.allSucceeded().uponSuccess(on: customExecutor) { _ in
+            expect.fulfill()
+        }
+
+        for slot in slab {
+            slot.succeed(with: slot.index)
+        }
+
+        wait(for: [ expect ], timeout: shortTimeout)
+        XCTAssertEqual(slab.compactMap { try? $0.peek()?.get() }, [ 0, 1, 2 ])
+    }
 }